@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+// Monetary amounts in integer base units (1 GXC = 10^8 units). Sums and balance
+// checks on Amount are exact, unlike the double fields they are converted from.
+typedef int64_t Amount;
+
+static const Amount COIN = 100000000;
+static const Amount MAX_MONEY = 31000000 * COIN;  // max supply
+
+inline bool moneyRange(Amount value) {
+    return value >= 0 && value <= MAX_MONEY;
+}
+
+// Rounds to the nearest base unit; fails on NaN, infinities and values outside
+// [-MAX_MONEY, MAX_MONEY]
+inline bool toAmount(double value, Amount& out) {
+    double units = value * static_cast<double>(COIN);
+    // Also rejects NaN, which fails every comparison
+    if (!(units <= static_cast<double>(MAX_MONEY) && units >= -static_cast<double>(MAX_MONEY))) return false;
+    // Round half away from zero, as std::round, without the libm call
+    out = static_cast<Amount>(units >= 0.0 ? units + 0.5 : units - 0.5);
+    return true;
+}
+
+inline double amountToDouble(Amount value) {
+    return static_cast<double>(value) / static_cast<double>(COIN);
+}
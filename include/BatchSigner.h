@@ -0,0 +1,29 @@
+#pragma once
+
+#include "transaction.h"
+#include "ThreadPool.h"
+#include <string>
+#include <vector>
+
+// Signs many transactions' inputs as one flat batch over the work-stealing pool,
+// for payout runs of tens of thousands of inputs. Each distinct private key gets a
+// signing context: the key is parsed and its public key derived once per batch, and
+// each worker builds signature messages in a reused buffer. Produces what calling
+// signInputs() on each transaction would (ECDSA nonces aside). Workers write only
+// input signature fields; transactions are invalidated once, after they finish.
+class BatchSigner {
+public:
+    explicit BatchSigner(ThreadPool& pool = ThreadPool::shared());
+
+    // privateKeys[i] signs every input of transactions[i]. Returns the number of
+    // inputs signed, or 0 if the arguments do not line up.
+    size_t sign(const std::vector<Transaction*>& transactions, const std::vector<std::string>& privateKeys) const;
+
+    // One key for the whole batch
+    size_t sign(std::vector<Transaction>& transactions, const std::string& privateKey) const;
+
+    static const size_t INPUTS_PER_TASK = 16;
+
+private:
+    ThreadPool& pool;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "transaction.h"
+#include <cstdint>
+#include <vector>
+
+// Transposed view of every amount in a block for the amount rules of
+// verifyTransaction(): each output positive and, for regular transactions,
+// |inputs - (outputs + fee)| < 1e-8 over double sums. Transactions are packed
+// four to a group, one per SIMD lane, with input k (and output k) of the four
+// stored side by side. A lane adds its own amounts in transaction order, padded
+// with +0.0, so every sum is the same sequence of IEEE additions as
+// getTotalInputAmount()/getTotalOutputAmount() and the verdicts match the
+// per-transaction checks exactly. Not a consensus path: the transactions are
+// still verified on their own; this only rejects a bad block early.
+class BlockAmountView {
+public:
+    static const size_t LANES = 4;
+
+    enum class Failure {
+        NONE,
+        NON_POSITIVE_OUTPUT,
+        TOTAL_OVERFLOW,         // a sum left the finite range, which the epsilon rule also rejects
+        UNBALANCED
+    };
+
+    struct CheckResult {
+        bool valid = true;
+        size_t txIndex = 0;
+        Failure failure = Failure::NONE;
+    };
+
+    void build(const std::vector<Transaction>& transactions);
+
+    // First transaction, in block order, that fails an amount rule
+    CheckResult check() const;
+
+    bool transactionValid(size_t tx) const;
+    size_t transactionCount() const { return txCount; }
+
+private:
+    // Verdict bits for the four lanes of a group, bit i set when lane i passes
+    unsigned evaluateGroup(size_t group) const;
+    Failure explain(size_t tx) const;
+
+    size_t txCount = 0;
+    std::vector<double> inputLanes;         // row r of group g: input r of its four transactions
+    std::vector<double> outputLanes;
+    std::vector<size_t> inputRowOffsets;    // per group, in rows; groupCount() + 1 entries
+    std::vector<size_t> outputRowOffsets;
+    std::vector<int64_t> outputCounts;      // per lane, padded to whole groups
+    std::vector<double> fees;
+    std::vector<int64_t> coinbase;          // -1 for coinbase and padding lanes, else 0
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Hash256.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Golomb-coded set over a block's output addresses and spent outpoints, with the
+// BIP158 parameters (P = 19, M = 784931): about 2.5 bytes per element and a 1 in
+// 784931 false-positive rate per query element. Elements are mapped into
+// [0, N * M) by SipHash keyed from the block hash, sorted, and stored as
+// Golomb-Rice coded deltas, so a light client can test its addresses without
+// downloading the block.
+class BlockFilter {
+public:
+    static const uint8_t P = 19;
+    static const uint64_t M = 784931;
+
+    BlockFilter() = default;
+
+    // Duplicate and empty elements are dropped
+    static BlockFilter build(const std::string& blockHash, std::vector<std::string> elements);
+
+    // Checks that the element count prefix is well formed
+    static bool fromEncoded(const std::string& blockHash, std::string encoded, BlockFilter& filter);
+
+    // Element for a spent outpoint: 32-byte binary tx hash followed by the LE index
+    static std::string outpointElement(const std::string& txHash, uint32_t index);
+
+    bool match(const std::string& element) const;
+
+    // One pass over the filter for the whole query set: O(N + Q log Q)
+    bool matchAny(const std::vector<std::string>& elements) const;
+
+    const std::string& getBlockHash() const { return blockHash; }
+    const std::string& getEncoded() const { return encoded; }
+    uint64_t getElementCount() const { return elementCount; }
+
+    Hash256 getFilterHash() const;
+
+    // header(n) = keccak256(filterHash(n) || header(n - 1)); header(-1) is all zero
+    static Hash256 computeHeader(const Hash256& filterHash, const Hash256& previousHeader);
+
+private:
+    void deriveKeys();
+    uint64_t hashToRange(const std::string& element) const;
+    std::vector<uint64_t> hashQuery(const std::vector<std::string>& elements) const;
+
+    std::string blockHash;
+    std::string encoded;        // CompactSize N, then the Golomb-Rice bit stream
+    uint64_t elementCount = 0;
+    size_t streamOffset = 0;
+    uint64_t k0 = 0;
+    uint64_t k1 = 0;
+};
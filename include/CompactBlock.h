@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Block.h"
+#include "Hash256.h"
+#include "transaction.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Mempool;
+
+// Relay form of a block: the header, one 6-byte short ID per transaction and a few
+// prefilled transactions (always the coinbase, which no peer can have yet). Short
+// IDs are SipHash-2-4 of the transaction hash, keyed from the block hash and a
+// per-announcement salt, so they cannot be ground in advance.
+class CompactBlock {
+public:
+    struct PrefilledTransaction {
+        uint32_t index = 0;
+        Transaction tx;
+    };
+
+    static const size_t SHORT_ID_BYTES = 6;
+    static const uint64_t SHORT_ID_MASK = 0xffffffffffffULL;
+
+    // Header, mirroring the fields Database::serializeBlock keeps
+    uint32_t index = 0;
+    std::string hash;
+    std::string previousHash;
+    std::string merkleRoot;
+    uint64_t timestamp = 0;
+    double difficulty = 0.0;
+    uint64_t nonce = 0;
+    std::string minerAddress;
+    int blockType = 0;
+
+    uint64_t salt = 0;
+    std::vector<uint64_t> shortIds;                 // for non-prefilled slots, in block order
+    std::vector<PrefilledTransaction> prefilled;    // ascending index
+
+    // extraPrefill lists further indexes to send in full, e.g. transactions the
+    // sender knows the peer has not seen
+    static CompactBlock fromBlock(const Block& block, uint64_t salt, const std::vector<uint32_t>& extraPrefill = {});
+
+    size_t transactionCount() const { return shortIds.size() + prefilled.size(); }
+
+    uint64_t shortId(const Hash256& txHash) const;
+    uint64_t shortId(const std::string& txHash) const;
+
+    std::string serialize() const;
+    static bool deserialize(const std::string& data, CompactBlock& block);
+
+private:
+    void deriveKeys() const;
+
+    mutable bool keysReady = false;
+    mutable uint64_t k0 = 0;
+    mutable uint64_t k1 = 0;
+};
+
+// Rebuilds a block from a CompactBlock and locally known transactions. Slots whose
+// short ID matches nothing, or matches more than one candidate, are reported as
+// missing so only those are requested from the peer.
+class PartialBlock {
+public:
+    enum class Status {
+        READY,          // every slot filled
+        MISSING,        // call getMissing() and supply the results
+        INVALID         // malformed compact block; fetch the full block
+    };
+
+    struct Stats {
+        size_t prefilled = 0;
+        size_t fromPool = 0;
+        size_t requested = 0;
+        size_t collisions = 0;
+    };
+
+    explicit PartialBlock(const CompactBlock& compact);
+
+    // Offers candidates; each is matched by short ID in O(1)
+    Status fill(const Mempool& mempool);
+    Status fill(const std::vector<Transaction>& candidates);
+
+    std::vector<uint32_t> getMissing() const;
+
+    // Transactions the peer returned for getMissing(), in the same order. Decode them
+    // with Transaction::deserializeBinary so each hash is recomputed from its fields.
+    Status supplyMissing(const std::vector<Transaction>& transactions);
+
+    // The caller must still check the merkle root: a short ID match is not proof
+    bool build(Block& block) const;
+
+    Status status() const;
+    const Stats& getStats() const { return stats; }
+
+private:
+    enum SlotState : uint8_t { EMPTY, PREFILLED, MATCHED, AMBIGUOUS };
+
+    void offer(uint64_t shortId, const Transaction& tx);
+
+    CompactBlock compact;
+    bool valid = true;
+    std::vector<Transaction> slots;
+    std::vector<uint8_t> states;
+    std::unordered_map<uint64_t, uint32_t> slotByShortId;
+    Stats stats;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace leveldb {
+class DB;
+}
+
+// Background, incremental replacement for a whole-keyspace CompactRange.
+// Deletions are counted per key slice (a tracked prefix plus a few following
+// characters); the slice with the most pending deletions is compacted next. Any
+// range whose approximate size exceeds the range limit is halved at a key midpoint
+// until it fits, so no single CompactRange call runs unbounded. Ranges are paced
+// by a token bucket filled at the byte rate, which is drawn down before each range
+// is compacted, and nothing runs while the node is busy.
+class CompactionScheduler {
+public:
+    struct Stats {
+        uint64_t rangesCompacted = 0;
+        uint64_t rangesSplit = 0;
+        uint64_t bytesCompacted = 0;
+        uint64_t pendingDeletions = 0;
+        size_t queuedRanges = 0;
+        bool paused = false;
+    };
+
+    explicit CompactionScheduler(leveldb::DB* db);
+    ~CompactionScheduler();
+
+    void start();
+    void stop();
+
+    // Track deletions under prefix, sliced by the sliceDepth characters after it
+    void trackPrefix(const std::string& prefix, size_t sliceDepth);
+    void recordDeletion(const std::string& key);
+
+    // Queue the whole keyspace: each tracked prefix and each gap between them
+    void requestFullPass();
+
+    // Nestable: compaction resumes once every pause() has been matched by resume()
+    void pause();
+    void resume();
+
+    void setMaxBytesPerSecond(uint64_t bytesPerSecond);
+    void setMaxRangeBytes(uint64_t bytes);
+    void setDeletionThreshold(uint64_t deletions);
+
+    Stats getStats() const;
+
+private:
+    struct KeyRange {
+        std::string start;
+        std::string limit;      // empty: to the end of the keyspace
+    };
+
+    void run();
+    bool nextRange(KeyRange& range);
+    uint64_t approximateSize(const KeyRange& range) const;
+    bool waitForBudget(std::unique_lock<std::mutex>& lock, uint64_t bytes);
+    void compact(const KeyRange& range, uint64_t bytes);
+
+    leveldb::DB* db;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    std::thread worker;
+    bool running;
+    int pauseDepth;
+
+    std::vector<std::pair<std::string, size_t>> trackedPrefixes;
+    std::map<std::string, uint64_t> pendingDeletions;
+    std::deque<KeyRange> queuedRanges;
+
+    uint64_t maxBytesPerSecond;
+    uint64_t maxRangeBytes;
+    uint64_t deletionThreshold;
+
+    // Token bucket in bytes, refilled at maxBytesPerSecond up to one second's worth
+    // or one full range, whichever is larger
+    double budgetBytes;
+    std::chrono::steady_clock::time_point budgetRefilled;
+
+    std::atomic<uint64_t> rangesCompacted;
+    std::atomic<uint64_t> rangesSplit;
+    std::atomic<uint64_t> bytesCompacted;
+};
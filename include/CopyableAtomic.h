@@ -0,0 +1,25 @@
+#pragma once
+
+#include <atomic>
+
+// std::atomic that copies and assigns by value, so lazily filled state (a cached
+// hash flag, memoized validation bits) can live in an otherwise copyable class.
+// Only the individual loads and stores are atomic: copying an object while another
+// thread mutates it is still a race, as for any other member.
+template <typename T>
+class CopyableAtomic {
+public:
+    CopyableAtomic(T initial = T()) : value(initial) {}
+    CopyableAtomic(const CopyableAtomic& other) : value(other.load()) {}
+    CopyableAtomic& operator=(const CopyableAtomic& other) {
+        store(other.load());
+        return *this;
+    }
+
+    T load(std::memory_order order = std::memory_order_acquire) const { return value.load(order); }
+    void store(T desired, std::memory_order order = std::memory_order_release) { value.store(desired, order); }
+    T fetchOr(T bits, std::memory_order order = std::memory_order_acq_rel) { return value.fetch_or(bits, order); }
+
+private:
+    std::atomic<T> value;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+
+// Scoped arena for decode scratch. While a Scope is alive on a thread, every
+// DecodeArena::Allocator on that thread draws from its memory resource, typically
+// a std::pmr::monotonic_buffer_resource sized for one block, so parsing a block's
+// records costs a handful of chunk allocations instead of one per JSON node.
+// Each allocation records the resource it came from, so it is returned there even
+// if it is freed after its Scope ended or under a different one; the resource
+// itself must outlive everything allocated from it. Outside any Scope the
+// allocator is plain new/delete.
+//
+// Only memory requested through the Allocator is arena memory. In particular the
+// std::string values inside an arena-allocated JSON document own ordinary heap
+// buffers, which is what lets decoders move them out into long-lived objects.
+namespace DecodeArena {
+
+inline std::pmr::memory_resource*& current() {
+    thread_local std::pmr::memory_resource* resource = nullptr;
+    return resource;
+}
+
+class Scope {
+public:
+    explicit Scope(std::pmr::memory_resource* resource) : previous(current()) { current() = resource; }
+    ~Scope() { current() = previous; }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    std::pmr::memory_resource* previous;
+};
+
+// Stateless so it fits containers that default-construct their allocator
+// (nlohmann::basic_json's AllocatorType)
+template <typename T>
+struct Allocator {
+    using value_type = T;
+
+    // Room for the owning resource pointer ahead of each allocation, keeping the
+    // payload at the fundamental alignment
+    static constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+
+    Allocator() noexcept = default;
+    template <typename U>
+    Allocator(const Allocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        static_assert(alignof(T) <= HEADER_SIZE, "DecodeArena::Allocator does not support over-aligned types");
+        std::pmr::memory_resource* resource = current();
+        size_t bytes = HEADER_SIZE + n * sizeof(T);
+        void* block = resource ? resource->allocate(bytes, HEADER_SIZE) : ::operator new(bytes);
+        std::memcpy(block, &resource, sizeof(resource));
+        return reinterpret_cast<T*>(static_cast<char*>(block) + HEADER_SIZE);
+    }
+
+    void deallocate(T* p, size_t n) {
+        char* block = reinterpret_cast<char*>(p) - HEADER_SIZE;
+        std::pmr::memory_resource* resource;
+        std::memcpy(&resource, block, sizeof(resource));
+        if (resource) {
+            resource->deallocate(block, HEADER_SIZE + n * sizeof(T), HEADER_SIZE);
+            return;
+        }
+        ::operator delete(block);
+    }
+
+    template <typename U>
+    bool operator==(const Allocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const Allocator<U>&) const noexcept { return false; }
+};
+
+}
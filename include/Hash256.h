@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Fixed-size 32-byte binary digest, for data that is hashed and compared as raw bytes
+// (block filters, compact block short IDs, batch Keccak output). Transaction and block
+// hashes stay hex strings: they are part of the legacy txid preimage and the storage keys.
+struct Hash256 {
+    static constexpr size_t SIZE = 32;
+
+    std::array<uint8_t, SIZE> bytes{};
+
+    static Hash256 fromBytes(const uint8_t* data) {
+        Hash256 hash;
+        std::memcpy(hash.bytes.data(), data, SIZE);
+        return hash;
+    }
+
+    // Accepts exactly 64 hex digits, either case
+    static bool fromHex(std::string_view hex, Hash256& out) {
+        if (hex.size() != SIZE * 2) return false;
+        for (size_t i = 0; i < SIZE; i++) {
+            int hi = hexValue(hex[2 * i]);
+            int lo = hexValue(hex[2 * i + 1]);
+            if (hi < 0 || lo < 0) return false;
+            out.bytes[i] = static_cast<uint8_t>((hi << 4) | lo);
+        }
+        return true;
+    }
+
+    std::string toHex() const {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex(SIZE * 2, '0');
+        for (size_t i = 0; i < SIZE; i++) {
+            hex[2 * i] = digits[bytes[i] >> 4];
+            hex[2 * i + 1] = digits[bytes[i] & 0x0f];
+        }
+        return hex;
+    }
+
+    // Appends the lowercase hex form without a temporary
+    void appendHex(std::string& out) const {
+        static const char digits[] = "0123456789abcdef";
+        for (uint8_t b : bytes) {
+            out.push_back(digits[b >> 4]);
+            out.push_back(digits[b & 0x0f]);
+        }
+    }
+
+    bool isNull() const {
+        for (uint8_t b : bytes) {
+            if (b != 0) return false;
+        }
+        return true;
+    }
+
+    uint64_t word(size_t index) const {
+        uint64_t w;
+        std::memcpy(&w, bytes.data() + 8 * index, sizeof(w));
+        return w;
+    }
+
+    bool operator==(const Hash256& other) const { return std::memcmp(bytes.data(), other.bytes.data(), SIZE) == 0; }
+    bool operator!=(const Hash256& other) const { return !(*this == other); }
+    bool operator<(const Hash256& other) const { return std::memcmp(bytes.data(), other.bytes.data(), SIZE) < 0; }
+
+private:
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+};
+
+namespace std {
+template <>
+struct hash<Hash256> {
+    // The bytes are already a cryptographic hash; any 8 of them are uniformly distributed
+    size_t operator()(const Hash256& hash) const { return static_cast<size_t>(hash.word(1)); }
+};
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Hash256.h"
+
+// Multi-buffer Keccak-256: hashes several independent messages at once by running
+// one permutation per SIMD lane (4 lanes with AVX2, 8 with AVX-512). The widest
+// implementation the CPU supports is picked at first use and must reproduce
+// KeccakHasher bit for bit on a self-test, otherwise the scalar path is used.
+class KeccakBatch {
+public:
+    enum class Implementation {
+        SCALAR,
+        AVX2,
+        AVX512
+    };
+
+    static void hash(const std::string_view* messages, size_t count, Hash256* digests);
+    static std::vector<Hash256> hash(const std::vector<std::string_view>& messages);
+
+    // Hex digests in the same form keccak256() returns
+    static std::vector<std::string> hashHex(const std::vector<std::string>& messages);
+
+    static Implementation implementation();
+    static const char* implementationName();
+    static size_t lanes();
+
+    // Forces an implementation for benchmarking; ignored if the CPU lacks it
+    static void setImplementation(Implementation impl);
+};
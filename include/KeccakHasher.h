@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Incremental Keccak-256 that produces the same digests as keccak256() in HashUtils.
+// Input is absorbed one rate block at a time from a fixed internal buffer, so hashing
+// never allocates; callers can stream fields straight into it.
+class KeccakHasher {
+public:
+    static const size_t RATE = 136;
+    static const size_t DIGEST_SIZE = 32;
+
+    KeccakHasher();
+
+    void reset();
+    void update(const void* data, size_t length);
+    void update(const std::string& data) { update(data.data(), data.size()); }
+
+    void finalize(uint8_t digest[DIGEST_SIZE]);
+    std::string finalizeHex();
+
+    static void permute(uint64_t state[25]);
+
+    // Domain padding byte matching keccak256(), or 0 when only the buffered fallback can
+    static uint8_t padding();
+
+    static const uint64_t ROUND_CONSTANTS[24];
+
+private:
+    void absorbBlock(const uint8_t* block);
+
+    uint64_t state[25];
+    uint8_t buffer[RATE];
+    size_t bufferLength;
+
+    // keccak256() may be original Keccak (0x01) or FIPS-202 SHA3 (0x06) padding; the
+    // right one is detected once against it, with a buffered fallback if neither matches
+    std::string fallback;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "transaction.h"
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Pending transaction pool ordered by fee rate.
+// Each entry tracks its in-pool parents and children and keeps running totals over
+// its ancestor and descendant packages, so block templates can be chosen by
+// ancestor fee rate (child-pays-for-parent) and eviction can drop the package with
+// the lowest descendant fee rate first.
+class Mempool {
+public:
+    enum class AddResult {
+        ADDED,
+        ALREADY_KNOWN,
+        CONFLICT,           // spends an outpoint another pool transaction already spends
+        MISSING_INPUTS,     // spends an outpoint neither the pool nor the coin lookup knows
+        INVALID,
+        TOO_LONG_CHAIN,     // ancestor or descendant package limit exceeded
+        MEMPOOL_FULL        // evicted straight away by the memory budget
+    };
+
+    struct Entry {
+        Transaction tx;
+        std::string hash;
+        double fee = 0.0;
+        size_t size = 0;            // serialized bytes
+        size_t memoryUsage = 0;
+        uint64_t sequence = 0;      // arrival order, breaks fee rate ties
+        std::unordered_set<std::string> parents;
+        std::unordered_set<std::string> children;
+
+        // Package totals, including the entry itself
+        double ancestorFee = 0.0;
+        size_t ancestorSize = 0;
+        size_t ancestorCount = 0;
+        double descendantFee = 0.0;
+        size_t descendantSize = 0;
+        size_t descendantCount = 0;
+
+        double feeRate() const { return fee / size; }
+        double ancestorFeeRate() const { return ancestorFee / ancestorSize; }
+        double descendantFeeRate() const { return descendantFee / descendantSize; }
+    };
+
+    static const size_t DEFAULT_MAX_MEMORY = 300 * 1024 * 1024;  // 300MB
+    static const size_t MAX_PACKAGE_COUNT = 25;
+
+    // Resolves a confirmed, unspent output; same contract as Database::getUTXO
+    using CoinLookup = std::function<bool(const std::string& txHash, uint32_t outputIndex, TransactionOutput& output)>;
+
+    explicit Mempool(size_t maxMemoryBytes = DEFAULT_MAX_MEMORY);
+
+    // The fee is what the resolved inputs are worth minus the outputs, never the
+    // transaction's self-declared fee. Inputs are resolved from pool parents first,
+    // then through lookupCoin.
+    AddResult add(const Transaction& tx, const CoinLookup& lookupCoin);
+
+    // Removes the transaction together with everything that depends on it
+    bool remove(const std::string& txHash);
+
+    // Drops transactions confirmed by a block and any that conflict with it
+    void removeForBlock(const std::vector<Transaction>& blockTransactions);
+
+    // Highest ancestor fee rate first, parents always before children; O(k log n)
+    std::vector<Transaction> selectForBlock(size_t maxBytes, size_t maxCount) const;
+
+    bool contains(const std::string& txHash) const;
+    bool get(const std::string& txHash, Transaction& tx) const;
+    std::string getSpender(const std::string& txHash, uint32_t outputIndex) const;
+
+    // Visits every pool transaction under the pool lock; visit must not call back in
+    void forEach(const std::function<void(const std::string&, const Transaction&)>& visit) const;
+
+    size_t size() const;
+    size_t getMemoryUsage() const;
+    size_t getMaxMemory() const { return maxMemory; }
+    double getMinFeeRate() const;
+
+private:
+    struct ScoreKey {
+        double score;
+        uint64_t sequence;
+        std::string hash;
+    };
+    struct HigherScoreFirst {
+        bool operator()(const ScoreKey& a, const ScoreKey& b) const {
+            if (a.score != b.score) return a.score > b.score;
+            return a.sequence < b.sequence;
+        }
+    };
+    struct LowerScoreFirst {
+        bool operator()(const ScoreKey& a, const ScoreKey& b) const {
+            if (a.score != b.score) return a.score < b.score;
+            return a.sequence > b.sequence;
+        }
+    };
+
+    static std::string outpointKey(const std::string& txHash, uint32_t outputIndex);
+
+    std::unordered_set<std::string> collectAncestors(const Entry& entry) const;
+    std::unordered_set<std::string> collectDescendants(const Entry& entry) const;
+
+    void unindex(const Entry& entry);
+    void reindex(const Entry& entry);
+    void removeEntry(const std::string& txHash);
+    void removeWithDescendants(const std::string& txHash);
+    void trimToBudget();
+
+    mutable std::mutex mutex;
+    size_t maxMemory;
+    size_t memoryUsage;
+    uint64_t nextSequence;
+
+    std::unordered_map<std::string, Entry> entries;
+    std::unordered_map<std::string, std::string> spentOutpoints;   // "txhash:index" -> spender
+    std::set<ScoreKey, HigherScoreFirst> byAncestorScore;           // template selection
+    std::set<ScoreKey, LowerScoreFirst> byDescendantScore;          // eviction
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Amount.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+
+namespace leveldb {
+class DB;
+class WriteBatch;
+struct ReadOptions;
+}
+
+struct RichListEntry {
+    std::string address;
+    Amount balance = 0;
+    size_t rank = 0;            // 1 = largest balance
+};
+
+// Addresses with balance in [minBalance, maxBalance); maxBalance 0 means unbounded
+struct RichListBucket {
+    Amount minBalance = 0;
+    Amount maxBalance = 0;
+    size_t addresses = 0;
+    Amount total = 0;
+};
+
+// Every address with a non-zero balance, ordered by balance. In memory it is a
+// red-black tree whose nodes also carry their subtree's entry count and balance
+// sum, so top-N, rank-of-address and histogram buckets cost O(log n) each. On disk
+// each address has one <prefix><inverted balance>:<address> key, so the keyspace
+// itself is sorted largest first and loads back without sorting.
+class RichList {
+public:
+    explicit RichList(const std::string& prefix);
+
+    // Replaces the in-memory index with the persisted one
+    bool load(leveldb::DB* db, const leveldb::ReadOptions& options);
+
+    // Adds the persisted form of applying balance deltas to batch and returns the
+    // resulting balances; pass them to apply() once the batch is written
+    std::vector<std::pair<std::string, Amount>> stage(leveldb::WriteBatch& batch,
+                                                      const std::map<std::string, Amount>& deltas) const;
+    void apply(const std::vector<std::pair<std::string, Amount>>& balances);
+
+    void clear();
+
+    // Persisted key for a balance; rebuilds write these directly
+    std::string key(const std::string& address, Amount balance) const;
+
+    std::vector<RichListEntry> top(size_t count, size_t offset = 0) const;
+    bool rank(const std::string& address, RichListEntry& entry) const;
+
+    // thresholds ascending; bucket i covers [thresholds[i], thresholds[i + 1])
+    std::vector<RichListBucket> histogram(const std::vector<Amount>& thresholds) const;
+
+    size_t size() const;
+    Amount totalBalance() const;
+
+private:
+    // Ordered by descending balance, then address
+    using TreeKey = std::pair<Amount, std::string>;     // (-balance, address)
+
+    struct NodeStats {
+        size_t count;
+        Amount total;
+    };
+
+    template <typename NodeConstIterator, typename NodeIterator, typename Compare, typename Allocator>
+    struct SubtreeStatsUpdate {
+        typedef NodeStats metadata_type;
+
+        void operator()(NodeIterator node, NodeConstIterator end) {
+            NodeStats stats{1, -(**node).first};
+            NodeIterator left = node.get_l_child();
+            NodeIterator right = node.get_r_child();
+            if (left != end) {
+                stats.count += left.get_metadata().count;
+                stats.total += left.get_metadata().total;
+            }
+            if (right != end) {
+                stats.count += right.get_metadata().count;
+                stats.total += right.get_metadata().total;
+            }
+            const_cast<NodeStats&>(node.get_metadata()) = stats;
+        }
+
+        // Count and balance sum of the keys ordered before key
+        NodeStats before(const TreeKey& key) const {
+            NodeStats stats{0, 0};
+            NodeConstIterator node = node_begin();
+            NodeConstIterator end = node_end();
+            while (node != end) {
+                NodeConstIterator left = node.get_l_child();
+                if (Compare()(**node, key)) {
+                    if (left != end) {
+                        stats.count += left.get_metadata().count;
+                        stats.total += left.get_metadata().total;
+                    }
+                    stats.count += 1;
+                    stats.total += -(**node).first;
+                    node = node.get_r_child();
+                } else {
+                    node = left;
+                }
+            }
+            return stats;
+        }
+
+        // The key at zero-based position index; index must be below the size
+        const TreeKey& at(size_t index) const {
+            NodeConstIterator node = node_begin();
+            NodeConstIterator end = node_end();
+            while (true) {
+                NodeConstIterator left = node.get_l_child();
+                size_t leftCount = left != end ? left.get_metadata().count : 0;
+                if (index < leftCount) {
+                    node = left;
+                } else if (index == leftCount) {
+                    return **node;
+                } else {
+                    index -= leftCount + 1;
+                    node = node.get_r_child();
+                }
+            }
+        }
+
+        virtual NodeConstIterator node_begin() const = 0;
+        virtual NodeConstIterator node_end() const = 0;
+        virtual ~SubtreeStatsUpdate() = default;
+    };
+
+    using Tree = __gnu_pbds::tree<TreeKey, __gnu_pbds::null_type, std::less<TreeKey>,
+                                  __gnu_pbds::rb_tree_tag, SubtreeStatsUpdate>;
+
+    void setLocked(const std::string& address, Amount balance);
+
+    std::string prefix;
+
+    mutable std::mutex mutex;
+    Tree tree;
+    std::unordered_map<std::string, Amount> balances;
+};
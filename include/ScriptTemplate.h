@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// An address reduced to bytes: the network, and the body after the "GXC"/"tGXC"
+// prefix decoded from lowercase hex. Anything else (no network prefix, odd length,
+// other characters) is kept verbatim as TEXT, so two addresses compare equal as bytes
+// exactly when their text is equal.
+struct DecodedAddress {
+    enum class Form : uint8_t {
+        HEX,
+        TEXT
+    };
+
+    Form form = Form::TEXT;
+    bool testnet = false;
+    std::string bytes;
+
+    static DecodedAddress decode(std::string_view address);
+
+    bool operator==(const DecodedAddress& other) const {
+        return form == other.form && testnet == other.testnet && bytes == other.bytes;
+    }
+    bool operator!=(const DecodedAddress& other) const { return !(*this == other); }
+};
+
+// Compact classification of a scriptPubKey. The text form
+// "OP_DUP OP_HASH160 <address> OP_EQUALVERIFY OP_CHECKSIG" is parsed once into a
+// template type plus the decoded address it locks to. Outputs keep their
+// classification next to the script (TransactionOutput::classifyScript), so
+// matching an input against it is a byte compare.
+struct ScriptTemplate {
+    enum class Type {
+        UNKNOWN,
+        P2PKH,          // standard pay-to-address script
+        BARE_ADDRESS    // legacy outputs whose script is just the address
+    };
+
+    Type type = Type::UNKNOWN;
+    DecodedAddress address;
+
+    static ScriptTemplate classify(std::string_view scriptPubKey);
+};
+
+// Bounded cache of publicKey -> address derivations. Address generation rehashes the
+// key on every call while the same wallet keys sign inputs block after block.
+namespace AddressCache {
+    static const size_t DEFAULT_CAPACITY = 1 << 16;
+
+    // Shared with the cache; a hit copies no address bytes
+    std::shared_ptr<const DecodedAddress> derive(const std::string& publicKey, bool testnet);
+
+    // True when publicKey hashes to exactly this address, on the address's own network
+    bool matches(const std::string& publicKey, const DecodedAddress& address);
+
+    double hitRate();
+    void clear();
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+struct LruCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t usage = 0;           // sum of entry charges
+    size_t capacity = 0;
+
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / lookups : 0.0;
+    }
+};
+
+// Bounded, thread-safe LRU map. Keys are spread over SHARDS independent LRU lists so
+// concurrent verifier threads rarely contend on the same lock. Capacity is split
+// evenly across shards; each shard evicts its own least recently used entries.
+// Every entry has a charge (1 by default, so capacity is an entry count); pass the
+// approximate byte size instead to bound memory.
+//
+// Read-through callers that load on a miss use generation()/putIfUnchanged() with
+// invalidate(): a value loaded before an invalidation of its key is never inserted
+// after it, so a concurrent miss cannot resurrect a deleted record.
+template <typename Key, typename Value, typename Hasher = std::hash<Key>, size_t SHARDS = 16>
+class ShardedLruCache {
+public:
+    using Stats = LruCacheStats;
+
+    explicit ShardedLruCache(size_t capacity)
+        : shardCapacity(capacity / SHARDS > 0 ? capacity / SHARDS : 1) {}
+
+    bool get(const Key& key, Value& value) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.index.find(key);
+        if (found == shard.index.end()) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        shard.order.splice(shard.order.begin(), shard.order, found->second);
+        value = found->second->value;
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void put(const Key& key, Value value, size_t charge = 1) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        insertLocked(shard, key, std::move(value), charge);
+    }
+
+    // Take before loading the value that will be passed to putIfUnchanged()
+    uint64_t generation() const { return invalidations.load(std::memory_order_acquire); }
+
+    // Inserts only if nothing was invalidated since observedGeneration was taken.
+    // The check runs under the key's shard lock, the same lock invalidate() bumps under.
+    bool putIfUnchanged(const Key& key, Value value, size_t charge, uint64_t observedGeneration) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (invalidations.load(std::memory_order_acquire) != observedGeneration) {
+            return false;
+        }
+        insertLocked(shard, key, std::move(value), charge);
+        return true;
+    }
+
+    // Erases the key and fails every putIfUnchanged() whose load began before this.
+    // Call it after the backing store has changed, not before.
+    void invalidate(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        invalidations.fetch_add(1, std::memory_order_acq_rel);
+        eraseLocked(shard, key);
+    }
+
+    void erase(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        eraseLocked(shard, key);
+    }
+
+    void clear() {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            invalidations.fetch_add(1, std::memory_order_acq_rel);
+            shard.index.clear();
+            shard.order.clear();
+            shard.usage = 0;
+        }
+    }
+
+    Stats getStats() const {
+        Stats stats;
+        stats.hits = hits.load(std::memory_order_relaxed);
+        stats.misses = misses.load(std::memory_order_relaxed);
+        stats.evictions = evictions.load(std::memory_order_relaxed);
+        stats.capacity = shardCapacity * SHARDS;
+        for (const auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.entries += shard.index.size();
+            stats.usage += shard.usage;
+        }
+        return stats;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        Value value;
+        size_t charge;
+    };
+
+    using List = std::list<Entry>;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        size_t usage = 0;
+        List order;     // most recently used first
+        std::unordered_map<Key, typename List::iterator, Hasher> index;
+    };
+
+    void insertLocked(Shard& shard, const Key& key, Value value, size_t charge) {
+        auto found = shard.index.find(key);
+        if (found != shard.index.end()) {
+            shard.usage -= found->second->charge;
+            found->second->value = std::move(value);
+            found->second->charge = charge;
+            shard.usage += charge;
+            shard.order.splice(shard.order.begin(), shard.order, found->second);
+        } else {
+            shard.order.push_front(Entry{key, std::move(value), charge});
+            shard.index.emplace(key, shard.order.begin());
+            shard.usage += charge;
+        }
+
+        // The newest entry always stays, even if it alone exceeds the shard budget
+        while (shard.usage > shardCapacity && shard.order.size() > 1) {
+            shard.usage -= shard.order.back().charge;
+            shard.index.erase(shard.order.back().key);
+            shard.order.pop_back();
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void eraseLocked(Shard& shard, const Key& key) {
+        auto found = shard.index.find(key);
+        if (found == shard.index.end()) return;
+        shard.usage -= found->second->charge;
+        shard.order.erase(found->second);
+        shard.index.erase(found);
+    }
+
+    Shard& shardFor(const Key& key) {
+        // Mix the hash so keys that differ only in high bits still spread
+        size_t h = Hasher()(key);
+        h ^= h >> 17;
+        return shards[h % SHARDS];
+    }
+
+    size_t shardCapacity;
+    std::array<Shard, SHARDS> shards;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> invalidations{0};
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <shared_mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Bounded cache of signatures that already verified, shared by mempool acceptance
+// and block connect so a transaction's signatures are checked once per node.
+// Entries are keccak(salt, message, signature, public key) with a per-process salt
+// from the OS-seeded CSPRNG, so peers cannot craft collisions. Reads take a per-shard
+// shared lock.
+class SignatureCache {
+public:
+    using Key = std::array<uint8_t, 32>;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t insertions = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t capacity = 0;
+
+        double hitRate() const {
+            uint64_t lookups = hits + misses;
+            return lookups ? static_cast<double>(hits) / lookups : 0.0;
+        }
+    };
+
+    static const size_t SHARD_COUNT = 32;
+    static const size_t DEFAULT_CAPACITY = 1 << 20;  // ~1M signatures
+
+    explicit SignatureCache(size_t capacity = DEFAULT_CAPACITY);
+
+    Key makeKey(const std::string& message, const std::string& signature, const std::string& publicKey) const;
+
+    bool contains(const Key& key);
+    void insert(const Key& key);
+    void clear();
+
+    Stats getStats() const;
+
+    static SignatureCache& instance();
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            size_t h;
+            std::memcpy(&h, key.data() + 8, sizeof(h));
+            return h;
+        }
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_set<Key, KeyHash> entries;
+        std::vector<Key> order;     // ring buffer in insertion order, for FIFO eviction
+        size_t next = 0;
+    };
+
+    Shard& shardFor(const Key& key) { return shards[key[0] % SHARD_COUNT]; }
+
+    std::array<uint8_t, 32> salt;
+    size_t shardCapacity;
+    std::array<Shard, SHARD_COUNT> shards;
+
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> insertions;
+    std::atomic<uint64_t> evictions;
+};
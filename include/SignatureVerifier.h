@@ -0,0 +1,33 @@
+#pragma once
+
+#include "transaction.h"
+#include "ThreadPool.h"
+#include <string>
+#include <vector>
+
+// Outcome of a batch signature check. On failure, txIndex/inputIndex name the
+// first failing input in batch order among those that were checked.
+struct SignatureVerificationResult {
+    bool valid = true;
+    size_t txIndex = 0;
+    size_t inputIndex = 0;
+    std::string txHash;
+    std::string error;
+    size_t checked = 0;
+};
+
+// Verifies every input signature of a block, or of a run of blocks during IBD,
+// as one flat batch spread over the work-stealing pool. Workers stop claiming
+// new checks as soon as any check fails.
+class SignatureVerifier {
+public:
+    explicit SignatureVerifier(ThreadPool& pool = ThreadPool::shared());
+
+    SignatureVerificationResult verify(const std::vector<Transaction>& transactions) const;
+    SignatureVerificationResult verify(const std::vector<const Transaction*>& transactions) const;
+
+    static const size_t CHECKS_PER_TASK = 16;
+
+private:
+    ThreadPool& pool;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// SipHash-2-4 (Aumasson & Bernstein). A keyed 64-bit PRF: fast on short inputs and
+// unpredictable without the key, so peers cannot grind colliding short IDs.
+class SipHasher {
+public:
+    SipHasher(uint64_t k0, uint64_t k1) : k0(k0), k1(k1) {}
+
+    uint64_t hash(const void* data, size_t length) const {
+        const uint8_t* in = static_cast<const uint8_t*>(data);
+        uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+        uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+        uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+        uint64_t v3 = 0x7465646279746573ULL ^ k1;
+
+        size_t blocks = length / 8;
+        for (size_t i = 0; i < blocks; i++) {
+            uint64_t m = load64(in + 8 * i);
+            v3 ^= m;
+            round(v0, v1, v2, v3);
+            round(v0, v1, v2, v3);
+            v0 ^= m;
+        }
+
+        uint64_t last = static_cast<uint64_t>(length) << 56;
+        const uint8_t* tail = in + 8 * blocks;
+        for (size_t i = 0; i < (length & 7); i++) {
+            last |= static_cast<uint64_t>(tail[i]) << (8 * i);
+        }
+        v3 ^= last;
+        round(v0, v1, v2, v3);
+        round(v0, v1, v2, v3);
+        v0 ^= last;
+
+        v2 ^= 0xff;
+        for (int i = 0; i < 4; i++) {
+            round(v0, v1, v2, v3);
+        }
+        return v0 ^ v1 ^ v2 ^ v3;
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int b) { return (x << b) | (x >> (64 - b)); }
+
+    static uint64_t load64(const uint8_t* p) {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; i--) {
+            v = (v << 8) | p[i];
+        }
+        return v;
+    }
+
+    static void round(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+        v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+        v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+    }
+
+    uint64_t k0;
+    uint64_t k1;
+};
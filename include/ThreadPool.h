@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool for CPU-bound batch jobs (signature checks, hashing).
+// Each worker owns a deque: it pops its own work from the back and steals from
+// the front of the others when idle, so uneven chunks still keep every core busy.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Runs body(begin, end) over [0, count) in chunks of at most grain items and
+    // returns when all chunks are done. The calling thread works too. The first
+    // exception thrown by body is rethrown here.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    // Process-wide pool sized to the hardware
+    static ThreadPool& shared();
+
+private:
+    using Task = std::function<void()>;
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(size_t index);
+    bool popTask(size_t index, Task& task);
+    bool stealTask(size_t thief, Task& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+    std::atomic<bool> stopping;
+    std::atomic<size_t> queuedTasks;
+};
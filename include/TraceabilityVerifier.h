@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Block.h"
+#include "Database.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One broken traceability link
+struct TraceabilityIssue {
+    std::string txHash;
+    uint32_t blockHeight = 0;
+    size_t inputIndex = 0;
+    std::string reason;
+};
+
+struct TraceabilityAuditReport {
+    uint32_t fromHeight = 0;
+    uint32_t toHeight = 0;
+    uint64_t blocksChecked = 0;
+    uint64_t transactionsChecked = 0;
+    uint64_t linksChecked = 0;
+    uint64_t issuesFound = 0;
+    std::vector<TraceabilityIssue> issues;   // first MAX_REPORTED_ISSUES only
+    bool completed = false;                  // false if stopped early
+    double elapsedSeconds = 0.0;
+};
+
+// Checks traceability links against stored chain data, not just within one
+// transaction: every input's referenced transaction must exist in an earlier
+// position of the chain, the referenced output must exist and carry the input's
+// amount, and (for stored transactions) the trace: record must agree with the
+// transaction. verifyBlock is for block connect; startAudit re-checks a height
+// range on a background thread with its own small pool, so it never competes with
+// block processing for the shared pool and takes no locks block connect needs.
+class TraceabilityVerifier {
+public:
+    struct Result {
+        bool valid = true;
+        size_t txIndex = 0;
+        TraceabilityIssue issue;
+        uint64_t linksChecked = 0;
+    };
+
+    struct Progress {
+        bool running = false;
+        uint32_t fromHeight = 0;
+        uint32_t toHeight = 0;
+        uint32_t currentHeight = 0;
+        uint64_t blocksChecked = 0;
+        uint64_t transactionsChecked = 0;
+        uint64_t linksChecked = 0;
+        uint64_t issuesFound = 0;
+
+        double fraction() const {
+            uint64_t total = static_cast<uint64_t>(toHeight) - fromHeight + 1;
+            return total ? static_cast<double>(blocksChecked) / total : 1.0;
+        }
+    };
+
+    static const size_t TRANSACTIONS_PER_TASK = 8;
+    static const size_t AUDIT_BATCH_TRANSACTIONS = 2048;
+    static const size_t MAX_REPORTED_ISSUES = 1000;
+
+    explicit TraceabilityVerifier(Database& db, ThreadPool& pool = ThreadPool::shared());
+    ~TraceabilityVerifier();
+
+    TraceabilityVerifier(const TraceabilityVerifier&) = delete;
+    TraceabilityVerifier& operator=(const TraceabilityVerifier&) = delete;
+
+    // Block connect: the block is not stored yet, so earlier transactions in the same
+    // block count as existing and no trace: records are expected
+    Result verifyBlock(const Block& block) const;
+
+    // Full-chain (or range) audit; returns false if one is already running.
+    // auditThreads = 0 uses a quarter of the hardware threads.
+    bool startAudit(uint32_t fromHeight, uint32_t toHeight, size_t auditThreads = 0);
+    void stopAudit();
+    bool isAuditRunning() const { return auditRunning; }
+
+    Progress getAuditProgress() const;
+    TraceabilityAuditReport getAuditReport() const;
+
+private:
+    struct Referenced;
+    struct BlockContext;
+
+    bool checkTransaction(const Transaction& tx, uint32_t blockHeight, const BlockContext* context, size_t position,
+                          bool checkTraceRecord, TraceabilityIssue& issue, uint64_t& links) const;
+    void runAudit(uint32_t fromHeight, uint32_t toHeight, size_t auditThreads);
+    void recordIssue(const TraceabilityIssue& issue);
+
+    Database& db;
+    ThreadPool& pool;
+
+    std::thread auditThread;
+    std::atomic<bool> auditRunning;
+    std::atomic<bool> stopRequested;
+    std::atomic<uint32_t> auditFrom;
+    std::atomic<uint32_t> auditTo;
+    std::atomic<uint32_t> auditHeight;
+    std::atomic<uint64_t> auditBlocks;
+    std::atomic<uint64_t> auditTransactions;
+    std::atomic<uint64_t> auditLinks;
+    std::atomic<uint64_t> auditIssues;
+
+    mutable std::mutex reportMutex;
+    TraceabilityAuditReport report;
+};
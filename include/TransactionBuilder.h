@@ -0,0 +1,41 @@
+#pragma once
+
+#include "transaction.h"
+#include <string>
+#include <vector>
+
+// Assembles a Transaction from decoded fields without rehashing per element.
+// Inputs and outputs are collected here and moved into the transaction once;
+// a known hash (e.g. the one stored alongside the record) is adopted as-is,
+// otherwise the hash is computed once, on first getHash().
+class TransactionBuilder {
+public:
+    TransactionBuilder();
+
+    TransactionBuilder& reserve(size_t inputCount, size_t outputCount);
+    TransactionBuilder& addInput(TransactionInput input);
+    TransactionBuilder& addOutput(TransactionOutput output);
+    TransactionBuilder& setInputs(std::vector<TransactionInput> inputs);
+    TransactionBuilder& setOutputs(std::vector<TransactionOutput> outputs);
+
+    // String fields are taken by value and moved through to the transaction
+    TransactionBuilder& setHash(std::string hash);
+    TransactionBuilder& setSenderAddress(std::string address);
+    TransactionBuilder& setReceiverAddress(std::string address);
+    TransactionBuilder& setFee(double fee);
+    TransactionBuilder& setTimestamp(uint64_t timestamp);
+    TransactionBuilder& setNonce(uint64_t nonce);
+    TransactionBuilder& setCoinbase(bool coinbase);
+    TransactionBuilder& setPrevTxHash(std::string prevTxHash);
+    TransactionBuilder& setReferencedAmount(double amount);
+
+    // Leaves the builder empty
+    Transaction build();
+
+private:
+    Transaction tx;
+    std::vector<TransactionInput> inputs;
+    std::vector<TransactionOutput> outputs;
+    std::string hash;
+    bool hasHash;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Amount.h"
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Incrementally maintained multiset hash of the UTXO set (LtHash, 1024 x 16-bit lanes).
+// Adding or removing an entry is O(1) and independent of set size; the order in which
+// entries are added does not matter, so two nodes with the same UTXO set agree on the hash.
+class UtxoSetHash {
+public:
+    static constexpr size_t LANES = 1024;
+
+    UtxoSetHash();
+
+    void add(const std::string& key, const std::string& value);
+    void remove(const std::string& key, const std::string& value);
+    void combine(const UtxoSetHash& other);
+    void clear();
+
+    // 32-byte keccak digest of the lane state, hex encoded
+    std::string digest() const;
+
+    // Full lane state for persistence between blocks
+    std::string serialize() const;
+    bool deserialize(const std::string& hex);
+
+private:
+    static void expand(const std::string& key, const std::string& value, std::array<uint16_t, LANES>& out);
+
+    std::array<uint16_t, LANES> lanes;
+};
+
+// Summary of the UTXO set at a given height, as returned by gettxoutsetinfo
+struct UtxoSetInfo {
+    uint32_t height = 0;
+    std::string hash;
+    uint64_t txoutCount = 0;
+    Amount totalAmount = 0;     // base units, exact under any order of updates
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace leveldb {
+class DB;
+struct WriteOptions;
+}
+
+// Counter changes for one validator, as produced by one block
+struct ValidatorDelta {
+    int64_t blocksProduced = 0;
+    int64_t missedBlocks = 0;
+    double totalRewards = 0.0;
+    double pendingRewards = 0.0;
+
+    ValidatorDelta& operator+=(const ValidatorDelta& other) {
+        blocksProduced += other.blocksProduced;
+        missedBlocks += other.missedBlocks;
+        totalRewards += other.totalRewards;
+        pendingRewards += other.pendingRewards;
+        return *this;
+    }
+};
+
+// Append-only validator metric updates. Each delta is a small record under
+// <deltaPrefix><address>:<sequence>; the base record under <basePrefix><address>
+// is only rewritten when a background thread folds an address's deltas into it,
+// once enough have accumulated or on a timer. The sum of unfolded deltas per
+// address is kept in memory, so a read is one base-record Get plus an O(1) lookup.
+class ValidatorMetricsLog {
+public:
+    struct Stats {
+        uint64_t deltasAppended = 0;
+        uint64_t deltasFolded = 0;
+        uint64_t recordsFolded = 0;
+        size_t pendingDeltas = 0;
+        size_t pendingValidators = 0;
+    };
+
+    ValidatorMetricsLog(leveldb::DB* db, const leveldb::WriteOptions& writeOptions,
+                        const std::string& basePrefix, const std::string& deltaPrefix);
+    ~ValidatorMetricsLog();
+
+    // Rebuilds the in-memory sums from stored deltas, dropping any whose base record
+    // is missing; call once before start()
+    bool load();
+
+    void start();
+    void stop();
+
+    // All deltas of one block in a single write. Fails, writing nothing, if any
+    // address has no stored base record: store the validator first.
+    bool append(const std::vector<std::pair<std::string, ValidatorDelta>>& deltas);
+
+    // Base record and unfolded deltas, read consistently with concurrent folds
+    bool read(const std::string& address, std::string& record, ValidatorDelta& pending) const;
+    ValidatorDelta pending(const std::string& address) const;
+
+    // Full rewrite of the base record; discards the address's unfolded deltas
+    bool replace(const std::string& address, const std::string& record);
+    bool remove(const std::string& address);
+
+    // Folds every address now, e.g. before a backup
+    bool foldAll();
+
+    void setFoldThreshold(size_t deltas);
+
+    Stats getStats() const;
+
+private:
+    struct Pending {
+        ValidatorDelta sum;
+        std::vector<uint64_t> sequences;
+    };
+
+    std::string deltaKey(const std::string& address, uint64_t sequence) const;
+
+    // Called with the mutex held
+    bool fold(const std::string& address);
+
+    void run();
+
+    leveldb::DB* db;
+    const leveldb::WriteOptions& writeOptions;
+    std::string basePrefix;
+    std::string deltaPrefix;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    std::thread worker;
+    bool running;
+    bool foldRequested;     // an address crossed the threshold since the last pass
+
+    std::unordered_map<std::string, Pending> pendingByAddress;
+    uint64_t nextSequence;
+    size_t foldThreshold;
+
+    std::atomic<uint64_t> deltasAppended;
+    std::atomic<uint64_t> deltasFolded;
+    std::atomic<uint64_t> recordsFolded;
+};
@@ -0,0 +1,167 @@
+#include "../include/BatchSigner.h"
+#include "../include/Crypto.h"
+#include "../include/Utils.h"
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h>
+#include <openssl/param_build.h>
+#include <openssl/sha.h>
+#include <unordered_map>
+
+namespace {
+
+// A private key parsed once per batch. Crypto::signData takes the key as hex and
+// rebuilds it for every call; this keeps the parsed key and produces the same
+// signatures: ECDSA over secp256k1 on the SHA-256 of the message, DER encoded, in hex.
+class SigningKey {
+public:
+    SigningKey() = default;
+    ~SigningKey() { EVP_PKEY_free(key); }
+    SigningKey(const SigningKey&) = delete;
+    SigningKey& operator=(const SigningKey&) = delete;
+    SigningKey(SigningKey&& other) noexcept : key(other.key) { other.key = nullptr; }
+
+    // False for anything but a 32-byte hex scalar; callers then fall back to Crypto
+    bool parse(const std::string& privateKeyHex) {
+        if (privateKeyHex.size() != 64 || !Utils::isValidHex(privateKeyHex)) return false;
+
+        BIGNUM* scalar = nullptr;
+        EC_GROUP* group = EC_GROUP_new_by_curve_name(NID_secp256k1);
+        EC_POINT* point = group ? EC_POINT_new(group) : nullptr;
+        OSSL_PARAM_BLD* builder = OSSL_PARAM_BLD_new();
+        OSSL_PARAM* params = nullptr;
+        EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_from_name(nullptr, "EC", nullptr);
+        unsigned char publicKey[65];
+
+        bool ok = point && builder && ctx && BN_hex2bn(&scalar, privateKeyHex.c_str()) == 64 &&
+                  !BN_is_zero(scalar) && BN_cmp(scalar, EC_GROUP_get0_order(group)) < 0 &&
+                  EC_POINT_mul(group, point, scalar, nullptr, nullptr, nullptr) == 1 &&
+                  EC_POINT_point2oct(group, point, POINT_CONVERSION_UNCOMPRESSED, publicKey,
+                                     sizeof(publicKey), nullptr) == sizeof(publicKey) &&
+                  OSSL_PARAM_BLD_push_utf8_string(builder, OSSL_PKEY_PARAM_GROUP_NAME, "secp256k1", 0) == 1 &&
+                  OSSL_PARAM_BLD_push_BN(builder, OSSL_PKEY_PARAM_PRIV_KEY, scalar) == 1 &&
+                  OSSL_PARAM_BLD_push_octet_string(builder, OSSL_PKEY_PARAM_PUB_KEY, publicKey,
+                                                   sizeof(publicKey)) == 1 &&
+                  (params = OSSL_PARAM_BLD_to_param(builder)) != nullptr &&
+                  EVP_PKEY_fromdata_init(ctx) == 1 &&
+                  EVP_PKEY_fromdata(ctx, &key, EVP_PKEY_KEYPAIR, params) == 1;
+
+        EVP_PKEY_CTX_free(ctx);
+        OSSL_PARAM_free(params);
+        OSSL_PARAM_BLD_free(builder);
+        EC_POINT_free(point);
+        EC_GROUP_free(group);
+        BN_clear_free(scalar);
+        return ok && key;
+    }
+
+    // Safe to call from several threads; each call signs through its own context
+    bool sign(const std::string& message, std::string& signatureHex) const {
+        unsigned char digest[SHA256_DIGEST_LENGTH];
+        SHA256(reinterpret_cast<const unsigned char*>(message.data()), message.size(), digest);
+
+        std::vector<uint8_t> der(72);
+        size_t length = der.size();
+        EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new(key, nullptr);
+        bool ok = ctx && EVP_PKEY_sign_init(ctx) == 1 &&
+                  EVP_PKEY_sign(ctx, der.data(), &length, digest, sizeof(digest)) == 1;
+        EVP_PKEY_CTX_free(ctx);
+        if (!ok) return false;
+
+        der.resize(length);
+        signatureHex = Utils::toHex(der);
+        return true;
+    }
+
+private:
+    EVP_PKEY* key = nullptr;
+};
+
+}
+
+BatchSigner::BatchSigner(ThreadPool& pool) : pool(pool) {
+}
+
+size_t BatchSigner::sign(std::vector<Transaction>& transactions, const std::string& privateKey) const {
+    std::vector<Transaction*> pointers;
+    pointers.reserve(transactions.size());
+    for (auto& tx : transactions) {
+        pointers.push_back(&tx);
+    }
+    return sign(pointers, std::vector<std::string>(transactions.size(), privateKey));
+}
+
+size_t BatchSigner::sign(const std::vector<Transaction*>& transactions,
+                         const std::vector<std::string>& privateKeys) const {
+    if (transactions.size() != privateKeys.size()) return 0;
+
+    // One signing context per distinct key: the key is parsed and its public key
+    // derived once for the whole batch
+    struct SigningContext {
+        const std::string* privateKey;
+        SigningKey parsed;
+        bool isParsed = false;
+        std::string publicKey;
+    };
+    std::vector<SigningContext> contexts;
+    std::vector<size_t> contextForTx(transactions.size());
+    {
+        std::unordered_map<std::string, size_t> byKey;
+        for (size_t t = 0; t < transactions.size(); t++) {
+            auto inserted = byKey.emplace(privateKeys[t], contexts.size());
+            if (inserted.second) {
+                contexts.emplace_back();
+                contexts.back().privateKey = &privateKeys[t];
+            }
+            contextForTx[t] = inserted.first->second;
+        }
+    }
+    pool.parallelFor(contexts.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            contexts[k].publicKey = Crypto::derivePublicKey(*contexts[k].privateKey);
+            contexts[k].isParsed = contexts[k].parsed.parse(*contexts[k].privateKey);
+        }
+    });
+
+    // Flatten to one entry per input so work splits evenly regardless of tx shape
+    struct Job {
+        size_t txIndex;
+        size_t inputIndex;
+    };
+    std::vector<Job> jobs;
+    for (size_t t = 0; t < transactions.size(); t++) {
+        for (size_t i = 0; i < transactions[t]->getInputs().size(); i++) {
+            jobs.push_back({t, i});
+        }
+    }
+
+    // Workers only write their own inputs' signature fields; the shared per-transaction
+    // state (hash, cached verdicts) is left alone until the serial phase below
+    pool.parallelFor(jobs.size(), INPUTS_PER_TASK, [&](size_t begin, size_t end) {
+        std::string message;
+        std::string signature;
+        for (size_t j = begin; j < end; j++) {
+            Transaction& tx = *transactions[jobs[j].txIndex];
+            const SigningContext& context = contexts[contextForTx[jobs[j].txIndex]];
+            TransactionInput& input = tx.inputs[jobs[j].inputIndex];
+
+            message.clear();
+            Transaction::appendSignatureMessage(message, input);
+            if (!context.isParsed || !context.parsed.sign(message, signature)) {
+                signature = Crypto::signData(message, *context.privateKey);
+            }
+            input.signature = std::move(signature);
+            input.publicKey = context.publicKey;
+        }
+    });
+
+    // Mark every transaction stale once, as signInputs() does, including ones with
+    // no inputs that no worker touched
+    for (Transaction* tx : transactions) {
+        tx->invalidate();
+    }
+
+    return jobs.size();
+}
@@ -0,0 +1,164 @@
+#include "../include/BlockAmounts.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+// GCC emits an AVX2 clone and a baseline clone and picks one at load time
+#define GXC_AMOUNT_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define GXC_AMOUNT_KERNEL
+#endif
+
+typedef double AmountLanes __attribute__((vector_size(32)));
+typedef int64_t LaneMask __attribute__((vector_size(32)));
+
+// The tolerance computeAmountConsistency() uses
+static const double BALANCE_EPSILON = 0.00000001;
+
+static inline __attribute__((always_inline)) AmountLanes loadLanes(const double* values) {
+    AmountLanes v;
+    std::memcpy(&v, values, sizeof(v));
+    return v;
+}
+
+static inline __attribute__((always_inline)) LaneMask loadMask(const int64_t* values) {
+    LaneMask v;
+    std::memcpy(&v, values, sizeof(v));
+    return v;
+}
+
+void BlockAmountView::build(const std::vector<Transaction>& transactions) {
+    txCount = transactions.size();
+    size_t groups = (txCount + LANES - 1) / LANES;
+
+    inputRowOffsets.assign(groups + 1, 0);
+    outputRowOffsets.assign(groups + 1, 0);
+    for (size_t g = 0; g < groups; g++) {
+        size_t inputRows = 0;
+        size_t outputRows = 0;
+        for (size_t t = g * LANES; t < std::min(txCount, (g + 1) * LANES); t++) {
+            inputRows = std::max(inputRows, transactions[t].getInputs().size());
+            outputRows = std::max(outputRows, transactions[t].getOutputs().size());
+        }
+        inputRowOffsets[g + 1] = inputRowOffsets[g] + inputRows;
+        outputRowOffsets[g + 1] = outputRowOffsets[g] + outputRows;
+    }
+
+    // Padding is +0.0, which leaves a lane's running sum unchanged
+    inputLanes.assign(inputRowOffsets[groups] * LANES, 0.0);
+    outputLanes.assign(outputRowOffsets[groups] * LANES, 0.0);
+    outputCounts.assign(groups * LANES, 0);
+    fees.assign(groups * LANES, 0.0);
+    coinbase.assign(groups * LANES, -1);
+
+    for (size_t t = 0; t < txCount; t++) {
+        const Transaction& tx = transactions[t];
+        size_t group = t / LANES;
+        size_t lane = t % LANES;
+
+        double* in = inputLanes.data() + inputRowOffsets[group] * LANES + lane;
+        for (const auto& input : tx.getInputs()) {
+            *in = input.amount;
+            in += LANES;
+        }
+        double* out = outputLanes.data() + outputRowOffsets[group] * LANES + lane;
+        for (const auto& output : tx.getOutputs()) {
+            *out = output.amount;
+            out += LANES;
+        }
+        outputCounts[t] = static_cast<int64_t>(tx.getOutputs().size());
+        fees[t] = tx.getFee();
+        coinbase[t] = tx.isCoinbaseTransaction() ? -1 : 0;
+    }
+}
+
+GXC_AMOUNT_KERNEL
+static unsigned evaluateLanes(const double* inputs, size_t inputRows, const double* outputs, size_t outputRows,
+                              const int64_t* outputCounts, const double* fees, const int64_t* coinbase) {
+    const AmountLanes zero = {0.0, 0.0, 0.0, 0.0};
+    const AmountLanes epsilon = {BALANCE_EPSILON, BALANCE_EPSILON, BALANCE_EPSILON, BALANCE_EPSILON};
+
+    AmountLanes inputTotal = zero;
+    for (size_t r = 0; r < inputRows; r++) {
+        inputTotal += loadLanes(inputs + r * BlockAmountView::LANES);
+    }
+
+    // !(v > 0) rather than v <= 0, so a NaN output fails as it does in the scalar check
+    LaneMask counts = loadMask(outputCounts);
+    LaneMask nonPositive = {0, 0, 0, 0};
+    AmountLanes outputTotal = zero;
+    for (size_t r = 0; r < outputRows; r++) {
+        AmountLanes v = loadLanes(outputs + r * BlockAmountView::LANES);
+        int64_t row = static_cast<int64_t>(r);
+        LaneMask real = LaneMask{row, row, row, row} < counts;
+        nonPositive |= real & ~(v > zero);
+        outputTotal += v;
+    }
+
+    // |d| < eps written as -eps < d < eps: identical for every d, NaN included
+    AmountLanes difference = inputTotal - (outputTotal + loadLanes(fees));
+    LaneMask balanced = (difference < epsilon) & (difference > -epsilon);
+    LaneMask pass = ~nonPositive & (loadMask(coinbase) | balanced);
+
+    unsigned bits = 0;
+    for (size_t lane = 0; lane < BlockAmountView::LANES; lane++) {
+        bits |= pass[lane] ? 1u << lane : 0u;
+    }
+    return bits;
+}
+
+unsigned BlockAmountView::evaluateGroup(size_t group) const {
+    size_t lane = group * LANES;
+    return evaluateLanes(inputLanes.data() + inputRowOffsets[group] * LANES,
+                         inputRowOffsets[group + 1] - inputRowOffsets[group],
+                         outputLanes.data() + outputRowOffsets[group] * LANES,
+                         outputRowOffsets[group + 1] - outputRowOffsets[group],
+                         outputCounts.data() + lane, fees.data() + lane, coinbase.data() + lane);
+}
+
+// Scalar walk over one lane, only for a transaction already known to fail
+BlockAmountView::Failure BlockAmountView::explain(size_t tx) const {
+    size_t group = tx / LANES;
+    size_t lane = tx % LANES;
+
+    double inputTotal = 0.0;
+    for (size_t r = inputRowOffsets[group]; r < inputRowOffsets[group + 1]; r++) {
+        inputTotal += inputLanes[r * LANES + lane];
+    }
+    double outputTotal = 0.0;
+    for (size_t r = outputRowOffsets[group]; r < outputRowOffsets[group + 1]; r++) {
+        double amount = outputLanes[r * LANES + lane];
+        if (static_cast<int64_t>(r - outputRowOffsets[group]) < outputCounts[tx] && !(amount > 0)) {
+            return Failure::NON_POSITIVE_OUTPUT;
+        }
+        outputTotal += amount;
+    }
+    if (!std::isfinite(inputTotal) || !std::isfinite(outputTotal + fees[tx])) {
+        return Failure::TOTAL_OVERFLOW;
+    }
+    return Failure::UNBALANCED;
+}
+
+BlockAmountView::CheckResult BlockAmountView::check() const {
+    CheckResult result;
+    size_t groups = inputRowOffsets.empty() ? 0 : inputRowOffsets.size() - 1;
+    for (size_t g = 0; g < groups; g++) {
+        unsigned bits = evaluateGroup(g);
+        if (bits == (1u << LANES) - 1) continue;
+
+        for (size_t lane = 0; lane < LANES; lane++) {
+            if (!(bits & (1u << lane))) {
+                result.valid = false;
+                result.txIndex = g * LANES + lane;
+                result.failure = explain(result.txIndex);
+                return result;
+            }
+        }
+    }
+    return result;
+}
+
+bool BlockAmountView::transactionValid(size_t tx) const {
+    return tx < txCount && (evaluateGroup(tx / LANES) & (1u << (tx % LANES))) != 0;
+}
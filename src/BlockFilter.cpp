@@ -0,0 +1,273 @@
+#include "../include/BlockFilter.h"
+#include "../include/KeccakHasher.h"
+#include "../include/SipHash.h"
+#include <algorithm>
+
+namespace {
+
+void writeCompactSize(std::string& out, uint64_t value) {
+    if (value < 0xfd) {
+        out.push_back(static_cast<char>(value));
+        return;
+    }
+    size_t bytes;
+    if (value <= 0xffff) {
+        out.push_back(static_cast<char>(0xfd));
+        bytes = 2;
+    } else if (value <= 0xffffffffULL) {
+        out.push_back(static_cast<char>(0xfe));
+        bytes = 4;
+    } else {
+        out.push_back(static_cast<char>(0xff));
+        bytes = 8;
+    }
+    for (size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+bool readCompactSize(const std::string& in, size_t& pos, uint64_t& value) {
+    if (pos >= in.size()) return false;
+    uint8_t first = static_cast<uint8_t>(in[pos++]);
+    size_t bytes = first < 0xfd ? 0 : first == 0xfd ? 2 : first == 0xfe ? 4 : 8;
+    if (bytes == 0) {
+        value = first;
+        return true;
+    }
+    if (pos + bytes > in.size()) return false;
+    value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(in[pos + i])) << (8 * i);
+    }
+    pos += bytes;
+    return true;
+}
+
+// MSB-first bit stream
+class BitWriter {
+public:
+    explicit BitWriter(std::string& out) : out(out) {}
+
+    void write(uint64_t value, int bits) {
+        while (bits > 0) {
+            int take = std::min(bits, 8 - used);
+            uint8_t chunk = static_cast<uint8_t>((value >> (bits - take)) & ((1u << take) - 1));
+            current = static_cast<uint8_t>((current << take) | chunk);
+            used += take;
+            bits -= take;
+            if (used == 8) flush();
+        }
+    }
+
+    void writeUnary(uint64_t count) {
+        for (; count >= 32; count -= 32) {
+            write(0xffffffffULL, 32);
+        }
+        write((1ULL << count) - 1, static_cast<int>(count));
+        write(0, 1);
+    }
+
+    void finish() {
+        if (used > 0) {
+            current = static_cast<uint8_t>(current << (8 - used));
+            flush();
+        }
+    }
+
+private:
+    void flush() {
+        out.push_back(static_cast<char>(current));
+        current = 0;
+        used = 0;
+    }
+
+    std::string& out;
+    uint8_t current = 0;
+    int used = 0;
+};
+
+class BitReader {
+public:
+    BitReader(const std::string& in, size_t pos) : in(in), pos(pos) {}
+
+    bool read(int bits, uint64_t& value) {
+        value = 0;
+        while (bits > 0) {
+            if (available == 0) {
+                if (pos >= in.size()) return false;
+                current = static_cast<uint8_t>(in[pos++]);
+                available = 8;
+            }
+            int take = std::min(bits, available);
+            value = (value << take) | ((current >> (available - take)) & ((1u << take) - 1));
+            available -= take;
+            bits -= take;
+        }
+        return true;
+    }
+
+    bool readUnary(uint64_t& count) {
+        count = 0;
+        uint64_t bit;
+        while (read(1, bit)) {
+            if (!bit) return true;
+            count++;
+        }
+        return false;
+    }
+
+private:
+    const std::string& in;
+    size_t pos;
+    uint8_t current = 0;
+    int available = 0;
+};
+
+// Reads the next value of the sorted set; false at the end or on truncation
+class GolombReader {
+public:
+    GolombReader(const std::string& in, size_t pos, uint64_t count) : bits(in, pos), remaining(count) {}
+
+    bool next(uint64_t& value) {
+        if (remaining == 0) return false;
+        uint64_t quotient, low;
+        if (!bits.readUnary(quotient) || !bits.read(BlockFilter::P, low)) return false;
+        last += (quotient << BlockFilter::P) | low;
+        value = last;
+        remaining--;
+        return true;
+    }
+
+private:
+    BitReader bits;
+    uint64_t remaining;
+    uint64_t last = 0;
+};
+
+}
+
+void BlockFilter::deriveKeys() {
+    Hash256 binary;
+    if (!Hash256::fromHex(blockHash, binary)) {
+        KeccakHasher hasher;
+        hasher.update(blockHash);
+        hasher.finalize(binary.bytes.data());
+    }
+    k0 = 0;
+    k1 = 0;
+    for (int i = 7; i >= 0; i--) {
+        k0 = (k0 << 8) | binary.bytes[i];
+        k1 = (k1 << 8) | binary.bytes[8 + i];
+    }
+}
+
+uint64_t BlockFilter::hashToRange(const std::string& element) const {
+    // Multiply-shift maps the 64-bit hash onto [0, N * M) without a division
+    uint64_t hash = SipHasher(k0, k1).hash(element.data(), element.size());
+    unsigned __int128 product = static_cast<unsigned __int128>(hash) * (elementCount * M);
+    return static_cast<uint64_t>(product >> 64);
+}
+
+std::vector<uint64_t> BlockFilter::hashQuery(const std::vector<std::string>& elements) const {
+    std::vector<uint64_t> values;
+    values.reserve(elements.size());
+    for (const auto& element : elements) {
+        values.push_back(hashToRange(element));
+    }
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+BlockFilter BlockFilter::build(const std::string& blockHash, std::vector<std::string> elements) {
+    std::sort(elements.begin(), elements.end());
+    elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+    elements.erase(std::remove(elements.begin(), elements.end(), std::string()), elements.end());
+    
+    BlockFilter filter;
+    filter.blockHash = blockHash;
+    filter.elementCount = elements.size();
+    filter.deriveKeys();
+    
+    std::vector<uint64_t> values = filter.hashQuery(elements);
+    
+    writeCompactSize(filter.encoded, filter.elementCount);
+    filter.streamOffset = filter.encoded.size();
+    
+    BitWriter writer(filter.encoded);
+    uint64_t last = 0;
+    for (uint64_t value : values) {
+        uint64_t delta = value - last;
+        writer.writeUnary(delta >> P);
+        writer.write(delta & ((1ULL << P) - 1), P);
+        last = value;
+    }
+    writer.finish();
+    return filter;
+}
+
+bool BlockFilter::fromEncoded(const std::string& blockHash, std::string encoded, BlockFilter& filter) {
+    size_t pos = 0;
+    uint64_t count;
+    if (!readCompactSize(encoded, pos, count)) return false;
+    // Every element costs at least P + 1 bits
+    if (count > (encoded.size() - pos) * 8 / (P + 1)) return false;
+    
+    filter.blockHash = blockHash;
+    filter.encoded = std::move(encoded);
+    filter.elementCount = count;
+    filter.streamOffset = pos;
+    filter.deriveKeys();
+    return true;
+}
+
+std::string BlockFilter::outpointElement(const std::string& txHash, uint32_t index) {
+    std::string element;
+    Hash256 binary;
+    if (Hash256::fromHex(txHash, binary)) {
+        element.assign(reinterpret_cast<const char*>(binary.bytes.data()), Hash256::SIZE);
+    } else {
+        element = txHash;
+    }
+    for (int i = 0; i < 4; i++) {
+        element.push_back(static_cast<char>((index >> (8 * i)) & 0xff));
+    }
+    return element;
+}
+
+bool BlockFilter::match(const std::string& element) const {
+    return matchAny({element});
+}
+
+bool BlockFilter::matchAny(const std::vector<std::string>& elements) const {
+    if (elementCount == 0 || elements.empty()) return false;
+    
+    std::vector<uint64_t> query = hashQuery(elements);
+    
+    // Merge the sorted query against the sorted set
+    GolombReader reader(encoded, streamOffset, elementCount);
+    uint64_t value;
+    size_t q = 0;
+    while (reader.next(value)) {
+        while (q < query.size() && query[q] < value) q++;
+        if (q == query.size()) return false;
+        if (query[q] == value) return true;
+    }
+    return false;
+}
+
+Hash256 BlockFilter::getFilterHash() const {
+    Hash256 hash;
+    KeccakHasher hasher;
+    hasher.update(encoded);
+    hasher.finalize(hash.bytes.data());
+    return hash;
+}
+
+Hash256 BlockFilter::computeHeader(const Hash256& filterHash, const Hash256& previousHeader) {
+    Hash256 header;
+    KeccakHasher hasher;
+    hasher.update(filterHash.bytes.data(), Hash256::SIZE);
+    hasher.update(previousHeader.bytes.data(), Hash256::SIZE);
+    hasher.finalize(header.bytes.data());
+    return header;
+}
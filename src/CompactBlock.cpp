@@ -0,0 +1,334 @@
+#include "../include/CompactBlock.h"
+#include "../include/KeccakHasher.h"
+#include "../include/Mempool.h"
+#include "../include/SipHash.h"
+#include <algorithm>
+#include <cstring>
+
+// Version 2 carries prefilled transactions in the exact binary encoding
+static const uint8_t COMPACT_BLOCK_VERSION = 2;
+
+// Upper bound on slots accepted from a peer before any allocation
+static const size_t MAX_COMPACT_TRANSACTIONS = 1000000;
+
+namespace {
+
+// Little-endian fixed-width writer/reader for the compact block wire format
+class Writer {
+public:
+    explicit Writer(std::string& out) : out(out) {}
+
+    void u8(uint8_t value) { out.push_back(static_cast<char>(value)); }
+
+    void uint(uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    void str(const std::string& value) {
+        uint(value.size(), 4);
+        out.append(value);
+    }
+
+private:
+    std::string& out;
+};
+
+class Reader {
+public:
+    explicit Reader(const std::string& in) : in(in), pos(0) {}
+
+    bool u8(uint8_t& value) {
+        if (pos + 1 > in.size()) return false;
+        value = static_cast<uint8_t>(in[pos++]);
+        return true;
+    }
+
+    bool uint(uint64_t& value, size_t bytes) {
+        if (pos + bytes > in.size()) return false;
+        value = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(in[pos + i])) << (8 * i);
+        }
+        pos += bytes;
+        return true;
+    }
+
+    bool str(std::string& value) {
+        uint64_t length;
+        if (!uint(length, 4) || pos + length > in.size()) return false;
+        value.assign(in, pos, length);
+        pos += length;
+        return true;
+    }
+
+    size_t remaining() const { return in.size() - pos; }
+
+private:
+    const std::string& in;
+    size_t pos;
+};
+
+}
+
+CompactBlock CompactBlock::fromBlock(const Block& block, uint64_t salt, const std::vector<uint32_t>& extraPrefill) {
+    CompactBlock compact;
+    compact.index = block.getIndex();
+    compact.hash = block.getHash();
+    compact.previousHash = block.getPreviousHash();
+    compact.merkleRoot = block.getMerkleRoot();
+    compact.timestamp = block.getTimestamp();
+    compact.difficulty = block.getDifficulty();
+    compact.nonce = block.getNonce();
+    compact.minerAddress = block.getMinerAddress();
+    compact.blockType = static_cast<int>(block.getBlockType());
+    compact.salt = salt;
+    
+    const auto& transactions = block.getTransactions();
+    std::vector<uint8_t> prefill(transactions.size(), 0);
+    for (uint32_t i : extraPrefill) {
+        if (i < prefill.size()) prefill[i] = 1;
+    }
+    
+    compact.shortIds.reserve(transactions.size());
+    for (uint32_t i = 0; i < transactions.size(); i++) {
+        if (prefill[i] || transactions[i].isCoinbaseTransaction()) {
+            compact.prefilled.push_back({i, transactions[i]});
+        } else {
+            compact.shortIds.push_back(compact.shortId(transactions[i].getHash()));
+        }
+    }
+    return compact;
+}
+
+void CompactBlock::deriveKeys() const {
+    if (keysReady) return;
+    
+    KeccakHasher hasher;
+    hasher.update(hash);
+    uint8_t saltBytes[8];
+    for (int i = 0; i < 8; i++) {
+        saltBytes[i] = static_cast<uint8_t>(salt >> (8 * i));
+    }
+    hasher.update(saltBytes, sizeof(saltBytes));
+    
+    uint8_t digest[KeccakHasher::DIGEST_SIZE];
+    hasher.finalize(digest);
+    std::memcpy(&k0, digest, sizeof(k0));
+    std::memcpy(&k1, digest + 8, sizeof(k1));
+    keysReady = true;
+}
+
+uint64_t CompactBlock::shortId(const Hash256& txHash) const {
+    deriveKeys();
+    return SipHasher(k0, k1).hash(txHash.bytes.data(), Hash256::SIZE) & SHORT_ID_MASK;
+}
+
+uint64_t CompactBlock::shortId(const std::string& txHash) const {
+    Hash256 binary;
+    if (Hash256::fromHex(txHash, binary)) {
+        return shortId(binary);
+    }
+    deriveKeys();
+    return SipHasher(k0, k1).hash(txHash.data(), txHash.size()) & SHORT_ID_MASK;
+}
+
+std::string CompactBlock::serialize() const {
+    std::string out;
+    out.reserve(128 + shortIds.size() * SHORT_ID_BYTES);
+    Writer writer(out);
+    
+    writer.u8(COMPACT_BLOCK_VERSION);
+    writer.uint(index, 4);
+    writer.str(hash);
+    writer.str(previousHash);
+    writer.str(merkleRoot);
+    writer.uint(timestamp, 8);
+    uint64_t difficultyBits;
+    std::memcpy(&difficultyBits, &difficulty, sizeof(difficultyBits));
+    writer.uint(difficultyBits, 8);
+    writer.uint(nonce, 8);
+    writer.str(minerAddress);
+    writer.u8(static_cast<uint8_t>(blockType));
+    writer.uint(salt, 8);
+    
+    writer.uint(shortIds.size(), 4);
+    for (uint64_t id : shortIds) {
+        writer.uint(id, SHORT_ID_BYTES);
+    }
+    
+    writer.uint(prefilled.size(), 4);
+    for (const auto& entry : prefilled) {
+        writer.uint(entry.index, 4);
+        writer.str(entry.tx.serializeBinary());
+    }
+    return out;
+}
+
+bool CompactBlock::deserialize(const std::string& data, CompactBlock& block) {
+    Reader reader(data);
+    CompactBlock result;
+    uint8_t version, blockType;
+    uint64_t index, difficultyBits, shortIdCount, prefilledCount;
+    
+    if (!reader.u8(version) || version != COMPACT_BLOCK_VERSION) return false;
+    if (!reader.uint(index, 4) || !reader.str(result.hash) || !reader.str(result.previousHash) ||
+        !reader.str(result.merkleRoot) || !reader.uint(result.timestamp, 8) || !reader.uint(difficultyBits, 8) ||
+        !reader.uint(result.nonce, 8) || !reader.str(result.minerAddress) || !reader.u8(blockType) ||
+        !reader.uint(result.salt, 8)) {
+        return false;
+    }
+    result.index = static_cast<uint32_t>(index);
+    std::memcpy(&result.difficulty, &difficultyBits, sizeof(difficultyBits));
+    result.blockType = blockType;
+    
+    // Counts are checked against the bytes actually present before reserving
+    if (!reader.uint(shortIdCount, 4) || shortIdCount > MAX_COMPACT_TRANSACTIONS ||
+        shortIdCount * SHORT_ID_BYTES > reader.remaining()) {
+        return false;
+    }
+    result.shortIds.resize(shortIdCount);
+    for (auto& id : result.shortIds) {
+        reader.uint(id, SHORT_ID_BYTES);
+    }
+    
+    if (!reader.uint(prefilledCount, 4) || shortIdCount + prefilledCount > MAX_COMPACT_TRANSACTIONS ||
+        prefilledCount * 8 > reader.remaining()) {
+        return false;
+    }
+    uint64_t total = shortIdCount + prefilledCount;
+    for (uint64_t i = 0; i < prefilledCount; i++) {
+        uint64_t slot;
+        std::string txData;
+        if (!reader.uint(slot, 4) || slot >= total) return false;
+        if (!result.prefilled.empty() && slot <= result.prefilled.back().index) return false;
+        if (!reader.str(txData)) return false;
+        
+        PrefilledTransaction entry;
+        entry.index = static_cast<uint32_t>(slot);
+        if (!entry.tx.deserializeBinary(txData)) return false;
+        result.prefilled.push_back(std::move(entry));
+    }
+    if (reader.remaining() != 0) return false;
+    
+    block = std::move(result);
+    return true;
+}
+
+PartialBlock::PartialBlock(const CompactBlock& compactIn)
+    : compact(compactIn) {
+    size_t total = compact.transactionCount();
+    slots.resize(total);
+    states.assign(total, EMPTY);
+    
+    for (const auto& entry : compact.prefilled) {
+        if (entry.index >= total || states[entry.index] != EMPTY) {
+            valid = false;
+            return;
+        }
+        slots[entry.index] = entry.tx;
+        states[entry.index] = PREFILLED;
+        stats.prefilled++;
+    }
+    
+    // Short IDs fill the remaining slots in order
+    slotByShortId.reserve(compact.shortIds.size());
+    size_t next = 0;
+    for (uint32_t slot = 0; slot < total; slot++) {
+        if (states[slot] == PREFILLED) continue;
+        if (!slotByShortId.emplace(compact.shortIds[next++], slot).second) {
+            // Two transactions of one block share a short ID; relay cannot disambiguate
+            valid = false;
+            return;
+        }
+    }
+}
+
+void PartialBlock::offer(uint64_t shortId, const Transaction& tx) {
+    auto found = slotByShortId.find(shortId);
+    if (found == slotByShortId.end()) return;
+    
+    uint32_t slot = found->second;
+    if (states[slot] == EMPTY) {
+        slots[slot] = tx;
+        states[slot] = MATCHED;
+        stats.fromPool++;
+    } else if (states[slot] == MATCHED && slots[slot].getHash() != tx.getHash()) {
+        // Two local candidates claim the slot; ask the peer instead of guessing
+        slots[slot] = Transaction();
+        states[slot] = AMBIGUOUS;
+        stats.fromPool--;
+        stats.collisions++;
+    }
+}
+
+PartialBlock::Status PartialBlock::fill(const Mempool& mempool) {
+    if (!valid) return Status::INVALID;
+    mempool.forEach([this](const std::string& hash, const Transaction& tx) {
+        offer(compact.shortId(hash), tx);
+    });
+    return status();
+}
+
+PartialBlock::Status PartialBlock::fill(const std::vector<Transaction>& candidates) {
+    if (!valid) return Status::INVALID;
+    for (const auto& tx : candidates) {
+        offer(compact.shortId(tx.getHash()), tx);
+    }
+    return status();
+}
+
+std::vector<uint32_t> PartialBlock::getMissing() const {
+    std::vector<uint32_t> missing;
+    for (uint32_t slot = 0; slot < states.size(); slot++) {
+        if (states[slot] == EMPTY || states[slot] == AMBIGUOUS) {
+            missing.push_back(slot);
+        }
+    }
+    return missing;
+}
+
+PartialBlock::Status PartialBlock::supplyMissing(const std::vector<Transaction>& transactions) {
+    if (!valid) return Status::INVALID;
+    
+    std::vector<uint32_t> missing = getMissing();
+    if (transactions.size() != missing.size()) return Status::INVALID;
+    
+    for (size_t i = 0; i < missing.size(); i++) {
+        uint32_t slot = missing[i];
+        // The peer must send what the short ID committed to
+        auto found = slotByShortId.find(compact.shortId(transactions[i].getHash()));
+        if (found == slotByShortId.end() || found->second != slot) return Status::INVALID;
+        slots[slot] = transactions[i];
+        states[slot] = MATCHED;
+        stats.requested++;
+    }
+    return status();
+}
+
+PartialBlock::Status PartialBlock::status() const {
+    if (!valid) return Status::INVALID;
+    for (uint8_t state : states) {
+        if (state == EMPTY || state == AMBIGUOUS) return Status::MISSING;
+    }
+    return Status::READY;
+}
+
+bool PartialBlock::build(Block& block) const {
+    if (status() != Status::READY) return false;
+    
+    Block result(compact.index, compact.previousHash, static_cast<BlockType>(compact.blockType));
+    result.setHash(compact.hash);
+    result.setMerkleRoot(compact.merkleRoot);
+    result.setTimestamp(compact.timestamp);
+    result.setDifficulty(compact.difficulty);
+    result.setNonce(compact.nonce);
+    result.setMinerAddress(compact.minerAddress);
+    for (const auto& tx : slots) {
+        result.addTransaction(tx);
+    }
+    
+    block = std::move(result);
+    return true;
+}
@@ -0,0 +1,280 @@
+#include "../include/CompactionScheduler.h"
+#include "../include/Logger.h"
+#include <leveldb/db.h>
+#include <algorithm>
+
+// Stands in for an open-ended limit when sizing or halving a range
+static const std::string KEYSPACE_END(16, '\xff');
+
+// Smallest key above every key that starts with prefix; empty if there is none
+static std::string successorKey(std::string prefix) {
+    while (!prefix.empty() && static_cast<uint8_t>(prefix.back()) == 0xff) {
+        prefix.pop_back();
+    }
+    if (!prefix.empty()) {
+        prefix.back() = static_cast<char>(static_cast<uint8_t>(prefix.back()) + 1);
+    }
+    return prefix;
+}
+
+// A key roughly halfway between start and limit: their first eight bytes past the
+// common prefix are read as big-endian integers and averaged. Empty when no key
+// strictly between them can be found that way.
+static std::string midpointKey(const std::string& start, const std::string& limitIn) {
+    const std::string& limit = limitIn.empty() ? KEYSPACE_END : limitIn;
+    size_t common = 0;
+    while (common < start.size() && common < limit.size() && start[common] == limit[common]) {
+        common++;
+    }
+    
+    uint64_t low = 0;
+    uint64_t high = 0;
+    for (size_t i = common; i < common + 8; i++) {
+        low = (low << 8) | (i < start.size() ? static_cast<uint8_t>(start[i]) : 0);
+        high = (high << 8) | (i < limit.size() ? static_cast<uint8_t>(limit[i]) : 0);
+    }
+    uint64_t middle = low / 2 + high / 2 + (low & high & 1);
+    
+    std::string key = start.substr(0, common);
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        key.push_back(static_cast<char>(middle >> shift));
+    }
+    if (key <= start || key >= limit) {
+        return std::string();
+    }
+    return key;
+}
+
+CompactionScheduler::CompactionScheduler(leveldb::DB* db)
+    : db(db), running(false), pauseDepth(0),
+      maxBytesPerSecond(16 * 1024 * 1024),  // 16MB/s
+      maxRangeBytes(32 * 1024 * 1024),      // 32MB, a handful of SST files
+      deletionThreshold(10000),
+      budgetBytes(0), budgetRefilled(std::chrono::steady_clock::now()),
+      rangesCompacted(0), rangesSplit(0), bytesCompacted(0) {
+}
+
+CompactionScheduler::~CompactionScheduler() {
+    stop();
+}
+
+void CompactionScheduler::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) return;
+    running = true;
+    worker = std::thread(&CompactionScheduler::run, this);
+}
+
+void CompactionScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        running = false;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void CompactionScheduler::trackPrefix(const std::string& prefix, size_t sliceDepth) {
+    std::lock_guard<std::mutex> lock(mutex);
+    trackedPrefixes.emplace_back(prefix, sliceDepth);
+}
+
+void CompactionScheduler::recordDeletion(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& tracked : trackedPrefixes) {
+        if (key.compare(0, tracked.first.size(), tracked.first) == 0) {
+            uint64_t& pending = pendingDeletions[key.substr(0, tracked.first.size() + tracked.second)];
+            if (++pending == deletionThreshold) {
+                wakeup.notify_one();
+            }
+            return;
+        }
+    }
+}
+
+void CompactionScheduler::requestFullPass() {
+    size_t queued = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t alreadyQueued = queuedRanges.size();
+        
+        // Outermost tracked prefixes only; a prefix inside another is covered by it
+        std::vector<std::string> prefixes;
+        for (const auto& tracked : trackedPrefixes) {
+            prefixes.push_back(tracked.first);
+        }
+        std::sort(prefixes.begin(), prefixes.end());
+        
+        // Each prefix, and each stretch of keyspace between them, is a range; ranges
+        // too large to compact in one go are halved when they are reached
+        std::string cursor;
+        bool openEnded = true;
+        for (const auto& prefix : prefixes) {
+            if (prefix < cursor) continue;
+            if (cursor < prefix) {
+                queuedRanges.push_back({cursor, prefix});
+            }
+            cursor = successorKey(prefix);
+            queuedRanges.push_back({prefix, cursor});
+            if (cursor.empty()) {
+                openEnded = false;
+                break;
+            }
+        }
+        if (openEnded) {
+            queuedRanges.push_back({cursor, std::string()});
+        }
+        queued = queuedRanges.size() - alreadyQueued;
+        pendingDeletions.clear();
+    }
+    wakeup.notify_one();
+    LOG_DATABASE(LogLevel::INFO, "Queued full background compaction pass over " + std::to_string(queued) + " ranges");
+}
+
+void CompactionScheduler::pause() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pauseDepth++;
+}
+
+void CompactionScheduler::resume() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pauseDepth > 0) pauseDepth--;
+    }
+    wakeup.notify_one();
+}
+
+void CompactionScheduler::setMaxBytesPerSecond(uint64_t bytesPerSecond) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxBytesPerSecond = bytesPerSecond;
+}
+
+void CompactionScheduler::setMaxRangeBytes(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxRangeBytes = bytes;
+}
+
+void CompactionScheduler::setDeletionThreshold(uint64_t deletions) {
+    std::lock_guard<std::mutex> lock(mutex);
+    deletionThreshold = std::max<uint64_t>(1, deletions);
+}
+
+CompactionScheduler::Stats CompactionScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats stats;
+    stats.rangesCompacted = rangesCompacted;
+    stats.rangesSplit = rangesSplit;
+    stats.bytesCompacted = bytesCompacted;
+    for (const auto& entry : pendingDeletions) {
+        stats.pendingDeletions += entry.second;
+    }
+    stats.queuedRanges = queuedRanges.size();
+    stats.paused = pauseDepth > 0;
+    return stats;
+}
+
+// Called with the mutex held
+bool CompactionScheduler::nextRange(KeyRange& range) {
+    // Explicitly queued ranges (full passes) go first
+    if (!queuedRanges.empty()) {
+        range = queuedRanges.front();
+        queuedRanges.pop_front();
+        return true;
+    }
+    
+    // Otherwise the slice with the most pending deletions, if it crossed the threshold
+    auto best = std::max_element(pendingDeletions.begin(), pendingDeletions.end(),
+                                 [](const auto& a, const auto& b) { return a.second < b.second; });
+    if (best == pendingDeletions.end() || best->second < deletionThreshold) {
+        return false;
+    }
+    
+    range.start = best->first;
+    range.limit = successorKey(best->first);
+    pendingDeletions.erase(best);
+    return true;
+}
+
+uint64_t CompactionScheduler::approximateSize(const KeyRange& range) const {
+    leveldb::Range sized(range.start, range.limit.empty() ? KEYSPACE_END : range.limit);
+    uint64_t bytes = 0;
+    db->GetApproximateSizes(&sized, 1, &bytes);
+    return bytes;
+}
+
+// Called with the mutex held. Takes bytes from the token bucket, waiting for it to
+// refill first if it is short; false if the scheduler was stopped or paused meanwhile.
+// A range larger than the bucket waits for a full bucket and leaves it in debt, which
+// the next range pays off.
+bool CompactionScheduler::waitForBudget(std::unique_lock<std::mutex>& lock, uint64_t bytes) {
+    while (running && pauseDepth == 0) {
+        if (maxBytesPerSecond == 0) {
+            return true;
+        }
+        
+        auto now = std::chrono::steady_clock::now();
+        double capacity = static_cast<double>(std::max(maxBytesPerSecond, maxRangeBytes));
+        double refill = std::chrono::duration<double>(now - budgetRefilled).count() * maxBytesPerSecond;
+        budgetBytes = std::min(capacity, budgetBytes + refill);
+        budgetRefilled = now;
+        
+        double needed = std::min(capacity, static_cast<double>(bytes));
+        if (budgetBytes >= needed) {
+            budgetBytes -= static_cast<double>(bytes);
+            return true;
+        }
+        wakeup.wait_for(lock, std::chrono::duration<double>((needed - budgetBytes) / maxBytesPerSecond));
+    }
+    return false;
+}
+
+void CompactionScheduler::compact(const KeyRange& range, uint64_t bytes) {
+    leveldb::Slice start(range.start);
+    leveldb::Slice limit(range.limit);
+    db->CompactRange(&start, range.limit.empty() ? nullptr : &limit);
+    
+    rangesCompacted++;
+    bytesCompacted += bytes;
+}
+
+void CompactionScheduler::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    
+    while (running) {
+        KeyRange range;
+        if (pauseDepth > 0 || !nextRange(range)) {
+            // Poll periodically so threshold changes and idle time are noticed
+            wakeup.wait_for(lock, std::chrono::seconds(5));
+            continue;
+        }
+        
+        uint64_t rangeLimit = maxRangeBytes;
+        lock.unlock();
+        uint64_t bytes = approximateSize(range);
+        std::string middle;
+        if (rangeLimit > 0 && bytes > rangeLimit) {
+            middle = midpointKey(range.start, range.limit);
+        }
+        lock.lock();
+        
+        // Halves go to the front so this range is finished before the next one starts
+        if (!middle.empty()) {
+            queuedRanges.push_front({middle, range.limit});
+            queuedRanges.push_front({range.start, middle});
+            rangesSplit++;
+            continue;
+        }
+        
+        if (!waitForBudget(lock, bytes)) {
+            queuedRanges.push_front(range);
+            continue;
+        }
+        
+        lock.unlock();
+        compact(range, bytes);
+        lock.lock();
+    }
+}
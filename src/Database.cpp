@@ -3,17 +3,54 @@
 #include "../include/Logger.h"
 #include "../include/Utils.h"
 #include "../include/Config.h"
+#include "../include/HashUtils.h"
+#include "../include/UtxoSetHash.h"
+#include "../include/CompactionScheduler.h"
+#include "../include/TransactionBuilder.h"
+#include "../include/DecodeArena.h"
+#include "../include/BlockFilter.h"
+#include "../include/ThreadPool.h"
+#include "../include/ValidatorMetricsLog.h"
+#include "../include/Amount.h"
+#include "../include/RichList.h"
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 #include <leveldb/cache.h>
 #include <leveldb/filter_policy.h>
 #include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <memory_resource>
 #include <fstream>
 #include <filesystem>
+#include <thread>
+#include <atomic>
+#include <charconv>
+#include <functional>
+#include <optional>
+#include <set>
+#include <snappy.h>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
+// Documents parsed on the read path take their nodes from the active DecodeArena
+using arena_json = nlohmann::basic_json<std::map, std::vector, std::string, bool, std::int64_t, std::uint64_t,
+                                        double, DecodeArena::Allocator>;
+
+// Scratch for one transaction record; release() rewinds to it without freeing
+static const size_t TX_DECODE_SCRATCH_BYTES = 16 * 1024;
+
+// Memory budgets for decoded blocks and transactions kept for hot reads
+static const size_t DECODED_BLOCK_CACHE_BYTES = 64 * 1024 * 1024;
+static const size_t DECODED_TX_CACHE_BYTES = 32 * 1024 * 1024;
+
+// Addresses per task in a batched addr: sweep
+static const size_t ADDRESS_SWEEP_GRAIN = 256;
+
+// A tip older than this means the node is still catching up (initial block download)
+static const uint64_t INITIAL_SYNC_TIP_AGE = 24 * 60 * 60;
+
 // Static instance
 std::unique_ptr<Database> Database::instance = nullptr;
 std::mutex Database::instanceMutex;
@@ -29,8 +66,351 @@ const std::string Database::PREFIX_PEER = "peer:";
 const std::string Database::PREFIX_CONFIG = "cfg:";
 const std::string Database::PREFIX_TRACE = "trace:";
 const std::string Database::PREFIX_ADDRESS = "addr:";
+const std::string Database::PREFIX_UTXO_STATS = "utxs:";
+const std::string Database::PREFIX_UTXO_UNDO = "utxu:";
+const std::string Database::PREFIX_HISTORY = "hist:";
+const std::string Database::PREFIX_FILTER = "cflt:";
+const std::string Database::PREFIX_VALIDATOR_DELTA = "vald:";
+const std::string Database::PREFIX_BALANCE = "bal:";
+const std::string Database::PREFIX_BALANCE_BLOCK = "balb:";
+const std::string Database::PREFIX_RICH = "rich:";
+
+// UTXO snapshot format
+static const uint32_t UTXO_SNAPSHOT_VERSION = 1;
+static const size_t UTXO_SNAPSHOT_CHUNK_ENTRIES = 50000;
+
+static void appendLengthPrefixed(std::string& out, const leveldb::Slice& data) {
+    uint32_t len = static_cast<uint32_t>(data.size());
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<char>((len >> (8 * i)) & 0xff));
+    }
+    out.append(data.data(), data.size());
+}
+
+static bool readLengthPrefixed(const std::string& in, size_t& pos, std::string& out) {
+    if (pos + 4 > in.size()) return false;
+    uint32_t len = 0;
+    for (int i = 0; i < 4; i++) {
+        len |= static_cast<uint32_t>(static_cast<uint8_t>(in[pos + i])) << (8 * i);
+    }
+    pos += 4;
+    if (pos + len > in.size()) return false;
+    out.assign(in, pos, len);
+    pos += len;
+    return true;
+}
+
+// Running UTXO set state: the hash lanes together with the height, output count and
+// total amount (in base units) they describe, so no write can update one without the others
+static std::string utxoSetStateRecord(const UtxoSetHash& setHash, const UtxoSetInfo& info) {
+    json state;
+    state["lanes"] = setHash.serialize();
+    state["height"] = info.height;
+    state["txout_count"] = info.txoutCount;
+    state["total_amount"] = info.totalAmount;
+    return state.dump();
+}
+
+// Stages UTXO changes into one write batch and keeps the set hash, output count and
+// total amount equal to what the batch leaves in storage. LevelDB reads cannot see
+// the batch, so entries written or deleted earlier in it are tracked here. What was
+// created and spent is kept as undo data, from which revert() restores the set.
+class UtxoSetUpdate {
+public:
+    using Reader = std::function<bool(const std::string& key, std::string& value)>;
+
+    UtxoSetUpdate(leveldb::WriteBatch& batch, Reader read, const std::string& utxoPrefix,
+                  const std::string& addressPrefix, UtxoSetHash& setHash, UtxoSetInfo& info)
+        : batch(batch), read(std::move(read)), utxoPrefix(utxoPrefix), addressPrefix(addressPrefix),
+          setHash(setHash), info(info) {}
+
+    // Removes a stored entry; false if there is none (unknown or already spent)
+    bool spend(const std::string& utxoKey, std::string& address, double& amount) {
+        std::string value;
+        if (!lookup(utxoKey, value)) {
+            batch.Delete(utxoKey);
+            deleted.push_back(utxoKey);
+            return false;
+        }
+        erase(utxoKey, value, address, amount);
+        
+        // Created and spent within this update: nothing to undo on either side
+        auto created = createdAt.find(utxoKey);
+        if (created != createdAt.end()) {
+            createdKeys[created->second].clear();
+            createdAt.erase(created);
+        } else {
+            spentEntries.emplace_back(utxoKey, std::move(value));
+        }
+        return true;
+    }
+
+    // Writes an entry; one already stored under the key is replaced, not counted twice
+    void create(const std::string& utxoKey, const std::string& value, const std::string& address, double amount) {
+        std::string previous, previousAddress;
+        double previousAmount;
+        if (lookup(utxoKey, previous)) {
+            erase(utxoKey, previous, previousAddress, previousAmount);
+            auto created = createdAt.find(utxoKey);
+            if (created != createdAt.end()) {
+                createdKeys[created->second].clear();
+            } else {
+                spentEntries.emplace_back(utxoKey, std::move(previous));
+            }
+        }
+        insert(utxoKey, value, address, amount);
+        createdAt[utxoKey] = createdKeys.size();
+        createdKeys.push_back(utxoKey);
+    }
+
+    // Undoes a recorded update: its outputs go, the entries it spent come back.
+    // Nothing is recorded for the revert itself.
+    void revert(const json& undo) {
+        const auto& created = undo["created"];
+        for (auto it = created.rbegin(); it != created.rend(); ++it) {
+            std::string key = it->get<std::string>();
+            std::string value, address;
+            double amount;
+            if (lookup(key, value)) {
+                erase(key, value, address, amount);
+            }
+        }
+        const auto& spent = undo["spent"];
+        for (auto it = spent.rbegin(); it != spent.rend(); ++it) {
+            std::string key = (*it)[0].get<std::string>();
+            std::string value = (*it)[1].get<std::string>();
+            std::string existing;
+            if (!lookup(key, existing)) {
+                json entry = json::parse(value);
+                insert(key, value, entry["address"].get<std::string>(), entry["amount"].get<double>());
+            }
+        }
+    }
+
+    json undoRecord(const std::string& blockHash) const {
+        json undo;
+        undo["block_hash"] = blockHash;
+        undo["created"] = json::array();
+        for (const auto& key : createdKeys) {
+            if (!key.empty()) undo["created"].push_back(key);
+        }
+        undo["spent"] = json::array();
+        for (const auto& entry : spentEntries) {
+            undo["spent"].push_back({entry.first, entry.second});
+        }
+        return undo;
+    }
+
+    // Deleted utxo: and addr: keys, for the compaction scheduler
+    const std::vector<std::string>& deletedKeys() const { return deleted; }
+
+private:
+    bool lookup(const std::string& utxoKey, std::string& value) const {
+        auto pending = overlay.find(utxoKey);
+        if (pending != overlay.end()) {
+            if (!pending->second) return false;
+            value = *pending->second;
+            return true;
+        }
+        return read(utxoKey, value);
+    }
+
+    // Totals are kept in base units so any order of adds and removes gives the same sum
+    static Amount units(double amount) {
+        Amount value = 0;
+        toAmount(amount, value);
+        return value;
+    }
+
+    std::string addressKey(const std::string& utxoKey, const std::string& address) const {
+        // utxo:<txhash>:<index> -> addr:<address>:<txhash>:<index>
+        return addressPrefix + address + ":" + utxoKey.substr(utxoPrefix.size());
+    }
+
+    void erase(const std::string& utxoKey, const std::string& value, std::string& address, double& amount) {
+        json entry = json::parse(value);
+        address = entry["address"].get<std::string>();
+        amount = entry["amount"].get<double>();
+        
+        setHash.remove(utxoKey, value);
+        info.txoutCount--;
+        info.totalAmount -= units(amount);
+        
+        std::string addrKey = addressKey(utxoKey, address);
+        batch.Delete(utxoKey);
+        batch.Delete(addrKey);
+        deleted.push_back(utxoKey);
+        deleted.push_back(std::move(addrKey));
+        overlay[utxoKey] = std::nullopt;
+    }
+
+    void insert(const std::string& utxoKey, const std::string& value, const std::string& address, double amount) {
+        setHash.add(utxoKey, value);
+        info.txoutCount++;
+        info.totalAmount += units(amount);
+        
+        batch.Put(utxoKey, value);
+        batch.Put(addressKey(utxoKey, address), value);
+        overlay[utxoKey] = value;
+    }
+
+    leveldb::WriteBatch& batch;
+    Reader read;
+    const std::string& utxoPrefix;
+    const std::string& addressPrefix;
+    UtxoSetHash& setHash;
+    UtxoSetInfo& info;
+    
+    std::unordered_map<std::string, std::optional<std::string>> overlay;   // nullopt: deleted in this batch
+    std::vector<std::string> createdKeys;                                  // cleared slots were spent again
+    std::unordered_map<std::string, size_t> createdAt;
+    std::vector<std::pair<std::string, std::string>> spentEntries;
+    std::vector<std::string> deleted;
+};
+
+// Filter elements: every output address and every spent outpoint
+static void appendFilterElements(const Transaction& tx, std::vector<std::string>& elements) {
+    for (const auto& input : tx.getInputs()) {
+        elements.push_back(BlockFilter::outpointElement(input.txHash, input.outputIndex));
+    }
+    for (const auto& output : tx.getOutputs()) {
+        elements.push_back(output.address);
+    }
+}
+
+// cflt:<height> value: block hash, filter header, encoded filter
+static std::string filterRecord(const BlockFilter& filter, const Hash256& header) {
+    std::string record;
+    record.reserve(filter.getBlockHash().size() + Hash256::SIZE + filter.getEncoded().size() + 12);
+    appendLengthPrefixed(record, filter.getBlockHash());
+    appendLengthPrefixed(record, leveldb::Slice(reinterpret_cast<const char*>(header.bytes.data()), Hash256::SIZE));
+    appendLengthPrefixed(record, filter.getEncoded());
+    return record;
+}
+
+static bool parseFilterRecord(const std::string& record, BlockFilter& filter, Hash256& header) {
+    size_t pos = 0;
+    std::string blockHash, headerBytes, encoded;
+    if (!readLengthPrefixed(record, pos, blockHash) || !readLengthPrefixed(record, pos, headerBytes) ||
+        !readLengthPrefixed(record, pos, encoded) || headerBytes.size() != Hash256::SIZE) {
+        return false;
+    }
+    header = Hash256::fromBytes(reinterpret_cast<const uint8_t*>(headerBytes.data()));
+    return BlockFilter::fromEncoded(blockHash, std::move(encoded), filter);
+}
+
+// Removes the hist: rows listed in a block's undo record
+static void deleteHistoryRows(leveldb::WriteBatch& batch, const json& undo) {
+    auto rows = undo.find("history");
+    if (rows == undo.end()) return;
+    for (const auto& key : *rows) {
+        batch.Delete(key.get<std::string>());
+    }
+}
+
+// Historical balance index
+// bal:<address>:<height> holds the address's balance change in that block and its
+// running balance after it, in base units; balb:<height> lists the addresses written
+// at that height so a replaced or deleted block can be unwound. Height is 64-bit so
+// callers can seek one past UINT32_MAX.
+static std::string balanceKey(const std::string& prefix, const std::string& address, uint64_t height) {
+    char digits[20];
+    char* end = std::to_chars(digits, digits + sizeof(digits), height).ptr;
+    size_t length = end - digits;
+    
+    std::string key;
+    key.reserve(prefix.size() + address.size() + 1 + std::max<size_t>(length, 10));
+    key.append(prefix);
+    key.append(address);
+    key.push_back(':');
+    if (length < 10) key.append(10 - length, '0');
+    key.append(digits, end);
+    return key;
+}
+
+// Running balance after the address's last change below height; 0 if it has none
+static bool balanceBefore(leveldb::Iterator* it, const std::string& prefix, const std::string& address,
+                          uint64_t height, Amount& balance) {
+    std::string addressPrefix = prefix + address + ":";
+    it->Seek(balanceKey(prefix, address, height));
+    if (it->Valid()) {
+        it->Prev();
+    } else {
+        it->SeekToLast();
+    }
+    
+    balance = 0;
+    if (!it->Valid() || !it->key().starts_with(addressPrefix)) {
+        return true;
+    }
+    json entry = json::parse(it->value().ToString());
+    balance = entry["balance"].get<Amount>();
+    return true;
+}
+
+static std::string balanceEntryToJson(Amount delta, Amount balance) {
+    json entry;
+    entry["delta"] = delta;
+    entry["balance"] = balance;
+    return entry.dump();
+}
+
+// Approximate heap footprint of decoded objects, used as their cache charge
+static size_t decodedSize(const Transaction& tx) {
+    size_t size = sizeof(Transaction) + tx.getHash().capacity() + tx.getPrevTxHash().capacity() +
+                  tx.getSenderAddress().capacity() + tx.getReceiverAddress().capacity();
+    for (const auto& input : tx.getInputs()) {
+        size += sizeof(TransactionInput) + input.txHash.capacity() + input.signature.capacity() + input.publicKey.capacity();
+    }
+    for (const auto& output : tx.getOutputs()) {
+        size += sizeof(TransactionOutput) + output.address.capacity() + output.script.capacity() +
+                output.scriptTemplate.address.bytes.capacity();
+    }
+    return size;
+}
+
+static size_t decodedSize(const Block& block) {
+    size_t size = sizeof(Block) + block.getHash().capacity() + block.getPreviousHash().size() +
+                  block.getMerkleRoot().size() + block.getMinerAddress().size();
+    for (const auto& tx : block.getTransactions()) {
+        size += decodedSize(tx);
+    }
+    return size;
+}
+
+// Holds background compaction off for a scope; CompactionScheduler pauses nest
+class CompactionPause {
+public:
+    explicit CompactionPause(CompactionScheduler* scheduler) : scheduler(scheduler) {
+        if (scheduler) scheduler->pause();
+    }
+    ~CompactionPause() {
+        if (scheduler) scheduler->resume();
+    }
+    CompactionPause(const CompactionPause&) = delete;
+    CompactionPause& operator=(const CompactionPause&) = delete;
+
+private:
+    CompactionScheduler* scheduler;
+};
+
+static std::string snapshotChunkName(size_t index) {
+    std::ostringstream oss;
+    oss << "utxo-" << std::setw(6) << std::setfill('0') << index << ".chunk";
+    return oss.str();
+}
 
-Database::Database() : db(nullptr) {
+static std::string snapshotCommitment(uint32_t height, const std::string& blockHash,
+                                      const std::string& utxoSetHash, const json& chunks) {
+    std::string preimage = std::to_string(height) + ":" + blockHash + ":" + utxoSetHash;
+    for (const auto& chunk : chunks) {
+        preimage += ":" + chunk["hash"].get<std::string>();
+    }
+    return keccak256(preimage);
+}
+
+Database::Database()
+    : db(nullptr), decodedBlocks(DECODED_BLOCK_CACHE_BYTES), decodedTransactions(DECODED_TX_CACHE_BYTES) {
     LOG_DATABASE(LogLevel::INFO, "Database instance created");
 }
 
@@ -134,6 +514,42 @@ bool Database::open(const std::string& dbPath) {
             return false;
         }
 
+        // Databases created before the UTXO set hash existed, or whose state record is
+        // unreadable, need a one-time full scan
+        UtxoSetHash storedSetHash;
+        UtxoSetInfo storedSetInfo;
+        std::string state;
+        if (!loadUtxoSetState(storedSetHash, storedSetInfo) && getConfigValue("latest_block_height", state)) {
+            rebuildUtxoSetHash();
+        }
+
+        // Spent outputs make utxo: and addr: the deletion-heavy prefixes; slice utxo: by the
+        // first hash digit and addr: by the two characters after the "GXC"/"tGXC" network prefix.
+        // The bare addr: entry catches any address without one of those prefixes
+        compactionScheduler = std::make_unique<CompactionScheduler>(db.get());
+        compactionScheduler->trackPrefix(PREFIX_UTXO, 1);
+        compactionScheduler->trackPrefix(PREFIX_ADDRESS + "GXC", 2);
+        compactionScheduler->trackPrefix(PREFIX_ADDRESS + "tGXC", 2);
+        compactionScheduler->trackPrefix(PREFIX_ADDRESS, 1);
+        compactionPausedForSync = false;
+        compactionScheduler->start();
+        
+        // Validator metric deltas left unfolded by the last run are summed back into memory
+        validatorMetrics = std::make_unique<ValidatorMetricsLog>(db.get(), writeOptions,
+                                                                 PREFIX_VALIDATOR, PREFIX_VALIDATOR_DELTA);
+        validatorMetrics->load();
+        validatorMetrics->start();
+        
+        // The rich list is rebuilt from addr: once, then maintained by saveBlock
+        richList = std::make_unique<RichList>(PREFIX_RICH);
+        if (getConfigValue("rich_list_ready", state)) {
+            richList->load(db.get(), readOptions);
+        } else if (getConfigValue("latest_block_height", state)) {
+            rebuildRichList();
+        } else {
+            setConfigValue("rich_list_ready", "1");
+        }
+
         LOG_DATABASE(LogLevel::INFO, "LevelDB database opened successfully");
         return true;
         
@@ -145,6 +561,14 @@ bool Database::open(const std::string& dbPath) {
 }
 
 void Database::close() {
+    // Stop background compaction before the handle it uses goes away
+    compactionScheduler.reset();
+    validatorMetrics.reset();
+    richList.reset();
+    
+    decodedBlocks.clear();
+    decodedTransactions.clear();
+    
     if (db) {
         db.reset();
         LOG_DATABASE(LogLevel::INFO, "Database closed");
@@ -305,41 +729,56 @@ std::string Database::serializeTransaction(const Transaction& tx) const {
     return j.dump();
 }
 
+// Moves a string out of a parsed document instead of copying it
+static std::string takeString(arena_json& value) {
+    return std::move(value.get_ref<std::string&>());
+}
+
+static Transaction transactionFromJson(arena_json& j) {
+    // Build in one pass and adopt the stored hash; no per-element rehashing
+    TransactionBuilder builder;
+    builder.setHash(takeString(j["hash"]))
+           .setSenderAddress(takeString(j["sender"]))
+           .setReceiverAddress(takeString(j["receiver"]))
+           .setFee(j["fee"].get<double>())
+           .setTimestamp(j["timestamp"].get<uint64_t>())
+           .setNonce(j["nonce"].get<uint64_t>())
+           .setCoinbase(j["is_coinbase"].get<bool>())
+           .setPrevTxHash(takeString(j["prev_tx_hash"]))
+           .setReferencedAmount(j["referenced_amount"].get<double>())
+           .reserve(j["inputs"].size(), j["outputs"].size());
+    
+    // Deserialize inputs
+    for (auto& inp : j["inputs"]) {
+        TransactionInput input;
+        input.txHash = takeString(inp["tx_hash"]);
+        input.outputIndex = inp["output_index"].get<uint32_t>();
+        input.amount = inp["amount"].get<double>();
+        input.signature = takeString(inp["signature"]);
+        builder.addInput(std::move(input));
+    }
+    
+    // Deserialize outputs
+    for (auto& out : j["outputs"]) {
+        TransactionOutput output;
+        output.address = takeString(out["address"]);
+        output.amount = out["amount"].get<double>();
+        output.script = takeString(out["script"]);
+        builder.addOutput(std::move(output));
+    }
+    
+    return builder.build();
+}
+
 Transaction Database::deserializeTransaction(const std::string& data) const {
+    // Typical records parse entirely inside the stack buffer
+    alignas(std::max_align_t) char scratch[4096];
+    std::pmr::monotonic_buffer_resource arena(scratch, sizeof(scratch));
+    DecodeArena::Scope scope(&arena);
+    
     try {
-        json j = json::parse(data);
-        
-        Transaction tx;
-        tx.setHash(j["hash"].get<std::string>());
-        tx.setSenderAddress(j["sender"].get<std::string>());
-        tx.setReceiverAddress(j["receiver"].get<std::string>());
-        tx.setFee(j["fee"].get<double>());
-        tx.setTimestamp(j["timestamp"].get<uint64_t>());
-        tx.setNonce(j["nonce"].get<uint64_t>());
-        tx.setCoinbaseTransaction(j["is_coinbase"].get<bool>());
-        tx.setPrevTxHash(j["prev_tx_hash"].get<std::string>());
-        tx.setReferencedAmount(j["referenced_amount"].get<double>());
-        
-        // Deserialize inputs
-        for (const auto& inp : j["inputs"]) {
-            TransactionInput input;
-            input.txHash = inp["tx_hash"].get<std::string>();
-            input.outputIndex = inp["output_index"].get<uint32_t>();
-            input.amount = inp["amount"].get<double>();
-            input.signature = inp["signature"].get<std::string>();
-            tx.addInput(input);
-        }
-        
-        // Deserialize outputs
-        for (const auto& out : j["outputs"]) {
-            TransactionOutput output;
-            output.address = out["address"].get<std::string>();
-            output.amount = out["amount"].get<double>();
-            output.script = out["script"].get<std::string>();
-            tx.addOutput(output);
-        }
-        
-        return tx;
+        arena_json j = arena_json::parse(data);
+        return transactionFromJson(j);
     } catch (const std::exception& e) {
         LOG_DATABASE(LogLevel::ERROR, "Failed to deserialize transaction: " + std::string(e.what()));
         return Transaction();
@@ -365,6 +804,11 @@ std::string Database::serializeValidator(const Validator& validator) const {
 }
 
 Validator Database::deserializeValidator(const std::string& data) const {
+    return deserializeValidator(data, ValidatorDelta());
+}
+
+// Base record plus the validator's deltas that have not been folded into it yet
+Validator Database::deserializeValidator(const std::string& data, const ValidatorDelta& pending) const {
     try {
         json j = json::parse(data);
         
@@ -377,10 +821,12 @@ Validator Database::deserializeValidator(const std::string& data) const {
         validator.setIsActive(j["is_active"].get<bool>());
         
         // Restore metrics
-        for (uint32_t i = 0; i < j["blocks_produced"].get<uint32_t>(); i++) {
+        int64_t blocksProduced = std::max<int64_t>(0, j["blocks_produced"].get<int64_t>() + pending.blocksProduced);
+        int64_t missedBlocks = std::max<int64_t>(0, j["missed_blocks"].get<int64_t>() + pending.missedBlocks);
+        for (int64_t i = 0; i < blocksProduced; i++) {
             validator.recordBlockProduced();
         }
-        for (uint32_t i = 0; i < j["missed_blocks"].get<uint32_t>(); i++) {
+        for (int64_t i = 0; i < missedBlocks; i++) {
             validator.recordMissedBlock();
         }
         
@@ -395,23 +841,68 @@ Validator Database::deserializeValidator(const std::string& data) const {
 bool Database::saveBlock(const Block& block) {
     if (!db) return false;
     
+    // The running UTXO set state is read, updated and written back as one step
+    std::lock_guard<std::mutex> utxoLock(utxoSetMutex);
+    
+    // Compaction competes with the block write for disk bandwidth
+    CompactionPause compactionPause(compactionScheduler.get());
+    
     try {
         // Use a single WriteBatch for all operations to avoid multiple writes
         leveldb::WriteBatch batch;
         
+        // Hash any stale transactions together; every tx hash is needed below
+        std::vector<const Transaction*> blockTxs;
+        blockTxs.reserve(block.getTransactions().size());
+        for (const auto& tx : block.getTransactions()) {
+            blockTxs.push_back(&tx);
+        }
+        Transaction::computeHashes(blockTxs);
+        
         // Store block by hash
         std::string blockData = serializeBlock(block);
         batch.Put(makeKey(PREFIX_BLOCK, block.getHash()), blockData);
         
-        // Store hash by height (for height-based lookups)
+        // Store hash by height (for height-based lookups); a different block at this
+        // height is being reorganised away, and its decoded copy goes once this commits
+        std::string replacedHash;
+        if (!get(makeKey(PREFIX_BLOCK_HEIGHT, block.getIndex()), replacedHash) || replacedHash == block.getHash()) {
+            replacedHash.clear();
+        }
         batch.Put(makeKey(PREFIX_BLOCK_HEIGHT, block.getIndex()), block.getHash());
         
         // Update latest block height
         batch.Put(makeKey(PREFIX_CONFIG, "latest_block_height"), std::to_string(block.getIndex()));
         batch.Put(makeKey(PREFIX_CONFIG, "latest_block_hash"), block.getHash());
         
+        // UTXO set hash is updated entry by entry as outputs are created and spent
+        UtxoSetHash utxoSetHash;
+        UtxoSetInfo utxoSetInfo;
+        loadUtxoSetState(utxoSetHash, utxoSetInfo);
+        UtxoSetUpdate utxoUpdate(batch, [this](const std::string& key, std::string& value) { return get(key, value); },
+                                 PREFIX_UTXO, PREFIX_ADDRESS, utxoSetHash, utxoSetInfo);
+        
+        // A block already stored at this height, whether replaced by a reorg or saved
+        // again, is undone first so its outputs and spends are not applied twice and
+        // its history rows do not outlive it
+        std::string undoData;
+        if (get(makeKey(PREFIX_UTXO_UNDO, block.getIndex()), undoData)) {
+            json undo = json::parse(undoData);
+            utxoUpdate.revert(undo);
+            deleteHistoryRows(batch, undo);
+        }
+        std::vector<std::string> filterElements;
+        std::map<std::string, Amount> balanceChanges;
+        json historyKeys = json::array();
+        
         // Store all transactions in the same batch
-        for (const auto& tx : block.getTransactions()) {
+        const auto& transactions = block.getTransactions();
+        for (uint32_t position = 0; position < transactions.size(); position++) {
+            const auto& tx = transactions[position];
+            
+            // Per-address sent/received totals for the history index
+            std::map<std::string, std::pair<double, double>> touched;
+            
             // Store transaction by hash
             std::string txData = serializeTransaction(tx);
             batch.Put(makeKey(PREFIX_TX, tx.getHash()), txData);
@@ -424,9 +915,14 @@ bool Database::saveBlock(const Block& block) {
             
             // Update UTXO set in the same batch
             // Remove spent UTXOs
+            // (spent outputs leave the address index too, so they no longer count towards balances)
             for (const auto& input : tx.getInputs()) {
                 std::string utxoKey = makeKey(PREFIX_UTXO, input.txHash + ":" + std::to_string(input.outputIndex));
-                batch.Delete(utxoKey);
+                std::string spentAddress;
+                double spentAmount;
+                if (utxoUpdate.spend(utxoKey, spentAddress, spentAmount)) {
+                    touched[spentAddress].first += spentAmount;
+                }
             }
             
             // Add new UTXOs
@@ -442,12 +938,25 @@ bool Database::saveBlock(const Block& block) {
                 utxo["script"] = output.script;
                 utxo["block_height"] = block.getIndex();
                 
+                // Written under utxo: and, for balance lookups, under addr:
                 std::string utxoKey = makeKey(PREFIX_UTXO, tx.getHash() + ":" + std::to_string(i));
-                batch.Put(utxoKey, utxo.dump());
+                utxoUpdate.create(utxoKey, utxo.dump(), output.address, output.amount);
+                touched[output.address].second += output.amount;
+            }
+            
+            appendFilterElements(tx, filterElements);
+            
+            // Index the transaction under every address it touched
+            for (const auto& entry : touched) {
+                std::string historyKey = makeHistoryKey(entry.first, block.getIndex(), position);
+                batch.Put(historyKey,
+                         historyEntryToJson(tx.getHash(), block.getIndex(), position, entry.second.first, entry.second.second));
+                historyKeys.push_back(std::move(historyKey));
                 
-                // Also index by address for balance lookups
-                std::string addrKey = makeKey(PREFIX_ADDRESS, output.address + ":" + tx.getHash() + ":" + std::to_string(i));
-                batch.Put(addrKey, utxo.dump());
+                Amount sent = 0, received = 0;
+                toAmount(entry.second.first, sent);
+                toAmount(entry.second.second, received);
+                balanceChanges[entry.first] += received - sent;
             }
             
             // Save traceability record in the same batch
@@ -465,6 +974,41 @@ bool Database::saveBlock(const Block& block) {
             }
         }
         
+        // Persist the running UTXO set state, its per-height summary and the undo data,
+        // which also lists the history rows written so a revert can remove them
+        utxoSetInfo.height = block.getIndex();
+        utxoSetInfo.hash = utxoSetHash.digest();
+        batch.Put(makeKey(PREFIX_CONFIG, "utxo_set_state"), utxoSetStateRecord(utxoSetHash, utxoSetInfo));
+        batch.Put(makeKey(PREFIX_UTXO_STATS, block.getIndex()), utxoSetInfoToJson(utxoSetInfo));
+        json undo = utxoUpdate.undoRecord(block.getHash());
+        undo["history"] = std::move(historyKeys);
+        batch.Put(makeKey(PREFIX_UTXO_UNDO, block.getIndex()), undo.dump());
+        
+        std::map<std::string, Amount> netBalanceChanges;
+        writeBalanceChanges(batch, block.getIndex(), balanceChanges, netBalanceChanges);
+        std::vector<std::pair<std::string, Amount>> richBalances;
+        if (richList) {
+            richBalances = richList->stage(batch, netBalanceChanges);
+        }
+        
+        // Compact filter, chained to the filter header of the parent height. A missing
+        // parent filter (a database from before filters existed) would silently restart
+        // the chain here, so the missing parent filters go into this batch first.
+        BlockFilter filter = BlockFilter::build(block.getHash(), std::move(filterElements));
+        Hash256 previousHeader;
+        if (block.getIndex() > 0) {
+            uint32_t parentHeight = block.getIndex() - 1;
+            BlockFilter parentFilter;
+            if (!getBlockFilter(parentHeight, parentFilter, previousHeader) &&
+                !backfillBlockFilters(parentHeight, batch, previousHeader)) {
+                LOG_DATABASE(LogLevel::ERROR, "Cannot save block " + std::to_string(block.getIndex()) +
+                             ": no filter header for its parent");
+                return false;
+            }
+        }
+        batch.Put(makeKey(PREFIX_FILTER, block.getIndex()),
+                 filterRecord(filter, BlockFilter::computeHeader(filter.getFilterHash(), previousHeader)));
+        
         // Single atomic write for everything
         leveldb::Status status = db->Write(writeOptions, &batch);
         if (!status.ok()) {
@@ -472,6 +1016,36 @@ bool Database::saveBlock(const Block& block) {
             return false;
         }
         
+        // The same hash saved again may carry different records
+        decodedBlocks.invalidate(block.getHash());
+        if (!replacedHash.empty()) {
+            decodedBlocks.invalidate(replacedHash);
+        }
+        
+        if (compactionScheduler) {
+            for (const auto& key : utxoUpdate.deletedKeys()) {
+                compactionScheduler->recordDeletion(key);
+            }
+        }
+        if (richList) {
+            richList->apply(richBalances);
+        }
+        
+        // Blocks far behind the clock arrive back to back during initial block download;
+        // compaction stays off until the chain reaches a recent block
+        uint64_t now = static_cast<uint64_t>(std::time(nullptr));
+        bool syncing = block.getTimestamp() + INITIAL_SYNC_TIP_AGE < now;
+        if (syncing != compactionPausedForSync) {
+            compactionPausedForSync = syncing;
+            if (syncing) {
+                pauseBackgroundCompaction();
+                LOG_DATABASE(LogLevel::INFO, "Initial block download: background compaction paused");
+            } else {
+                resumeBackgroundCompaction();
+                LOG_DATABASE(LogLevel::INFO, "Caught up with the network: background compaction resumed");
+            }
+        }
+        
         LOG_DATABASE(LogLevel::DEBUG, "Saved block: " + block.getHash().substr(0, 16) + "... with " + 
                     std::to_string(block.getTransactions().size()) + " transactions");
         return true;
@@ -495,6 +1069,42 @@ bool Database::getBlock(uint32_t index, Block& block) const {
 }
 
 bool Database::getBlock(const std::string& hash, Block& block) const {
+    std::shared_ptr<const Block> cached = getBlockShared(hash);
+    if (!cached) {
+        return false;
+    }
+    block = *cached;
+    return true;
+}
+
+// Decoded blocks are immutable and shared; a hit skips LevelDB and JSON parsing.
+// Lazily filled state (transaction hashes) is computed before the block is published,
+// so readers sharing it never write to it.
+std::shared_ptr<const Block> Database::getBlockShared(const std::string& hash) const {
+    std::shared_ptr<const Block> cached;
+    if (decodedBlocks.get(hash, cached)) {
+        return cached;
+    }
+    
+    // Taken before the read, so a block deleted meanwhile is not cached after its delete
+    uint64_t generation = decodedBlocks.generation();
+    auto block = std::make_shared<Block>();
+    if (!loadBlock(hash, *block)) {
+        return nullptr;
+    }
+    
+    std::vector<const Transaction*> transactions;
+    transactions.reserve(block->getTransactions().size());
+    for (const auto& tx : block->getTransactions()) {
+        transactions.push_back(&tx);
+    }
+    Transaction::computeHashes(transactions);
+    
+    decodedBlocks.putIfUnchanged(hash, block, decodedSize(*block), generation);
+    return block;
+}
+
+bool Database::loadBlock(const std::string& hash, Block& block) const {
     std::string data;
     if (!get(makeKey(PREFIX_BLOCK, hash), data)) {
         return false;
@@ -504,8 +1114,8 @@ bool Database::getBlock(const std::string& hash, Block& block) const {
     
     // Load transactions
     auto transactions = getTransactionsByBlockHash(hash);
-    for (const auto& tx : transactions) {
-        block.addTransaction(tx);
+    for (auto& tx : transactions) {
+        block.addTransaction(std::move(tx));
     }
     
     return true;
@@ -518,6 +1128,8 @@ Block Database::getBlock(const std::string& hash) const {
 }
 
 bool Database::deleteBlock(uint32_t index) {
+    std::lock_guard<std::mutex> utxoLock(utxoSetMutex);
+    
     std::string hash;
     if (!get(makeKey(PREFIX_BLOCK_HEIGHT, index), hash)) {
         return false;
@@ -526,8 +1138,71 @@ bool Database::deleteBlock(uint32_t index) {
     leveldb::WriteBatch batch;
     batch.Delete(makeKey(PREFIX_BLOCK, hash));
     batch.Delete(makeKey(PREFIX_BLOCK_HEIGHT, index));
+    batch.Delete(makeKey(PREFIX_FILTER, index));
     
-    return db->Write(writeOptions, &batch).ok();
+    // Put the UTXO set back as it was before the block: its outputs go, its spends return
+    UtxoSetHash utxoSetHash;
+    UtxoSetInfo utxoSetInfo;
+    loadUtxoSetState(utxoSetHash, utxoSetInfo);
+    UtxoSetUpdate utxoUpdate(batch, [this](const std::string& key, std::string& value) { return get(key, value); },
+                             PREFIX_UTXO, PREFIX_ADDRESS, utxoSetHash, utxoSetInfo);
+    std::string undoData;
+    if (get(makeKey(PREFIX_UTXO_UNDO, index), undoData)) {
+        try {
+            json undo = json::parse(undoData);
+            utxoUpdate.revert(undo);
+            deleteHistoryRows(batch, undo);
+        } catch (const std::exception& e) {
+            LOG_DATABASE(LogLevel::ERROR, "Unreadable UTXO undo data for height " + std::to_string(index) + ": " + e.what());
+            return false;
+        }
+        utxoSetInfo.height = index > 0 ? index - 1 : 0;
+        utxoSetInfo.hash = utxoSetHash.digest();
+        batch.Put(makeKey(PREFIX_CONFIG, "utxo_set_state"), utxoSetStateRecord(utxoSetHash, utxoSetInfo));
+        batch.Delete(makeKey(PREFIX_UTXO_UNDO, index));
+    } else {
+        LOG_DATABASE(LogLevel::WARNING, "No UTXO undo data for height " + std::to_string(index) +
+                    "; the UTXO set keeps the block's changes");
+    }
+    batch.Delete(makeKey(PREFIX_UTXO_STATS, index));
+    
+    // Unwind the block's balance entries; later heights are rewritten as the chain regrows
+    std::string touchedData;
+    std::map<std::string, Amount> reversed;
+    if (get(makeKey(PREFIX_BALANCE_BLOCK, index), touchedData)) {
+        try {
+            for (const auto& address : json::parse(touchedData)) {
+                std::string key = balanceKey(PREFIX_BALANCE, address.get<std::string>(), index);
+                std::string entryData;
+                if (get(key, entryData)) {
+                    reversed[address.get<std::string>()] -= json::parse(entryData)["delta"].get<Amount>();
+                }
+                batch.Delete(key);
+            }
+        } catch (const std::exception& e) {
+            LOG_DATABASE(LogLevel::WARNING, "Unreadable balance index for height " + std::to_string(index) + ": " + e.what());
+        }
+        batch.Delete(makeKey(PREFIX_BALANCE_BLOCK, index));
+    }
+    std::vector<std::pair<std::string, Amount>> richBalances;
+    if (richList) {
+        richBalances = richList->stage(batch, reversed);
+    }
+    
+    if (!db->Write(writeOptions, &batch).ok()) {
+        return false;
+    }
+    // Transaction records stay in storage, so only the block leaves the cache
+    decodedBlocks.invalidate(hash);
+    if (compactionScheduler) {
+        for (const auto& key : utxoUpdate.deletedKeys()) {
+            compactionScheduler->recordDeletion(key);
+        }
+    }
+    if (richList) {
+        richList->apply(richBalances);
+    }
+    return true;
 }
 
 uint32_t Database::getLatestBlockIndex() const {
@@ -555,10 +1230,11 @@ std::vector<Block> Database::getAllBlocks() const {
         std::string key = it->key().ToString();
         if (key.find(PREFIX_BLOCK_HEIGHT) != 0) break;
         
+        // A full-chain load would evict every hot entry, so bypass the cache
         std::string hash = it->value().ToString();
         Block block;
-        if (getBlock(hash, block)) {
-            blocks.push_back(block);
+        if (loadBlock(hash, block)) {
+            blocks.push_back(std::move(block));
         }
     }
     
@@ -640,12 +1316,21 @@ bool Database::saveTransactionOutputs(const Transaction& tx) {
 bool Database::updateUtxoSet(const Transaction& tx, size_t blockHeight) {
     if (!db) return false;
     
+    std::lock_guard<std::mutex> utxoLock(utxoSetMutex);
     leveldb::WriteBatch batch;
     
+    UtxoSetHash utxoSetHash;
+    UtxoSetInfo utxoSetInfo;
+    loadUtxoSetState(utxoSetHash, utxoSetInfo);
+    UtxoSetUpdate utxoUpdate(batch, [this](const std::string& key, std::string& value) { return get(key, value); },
+                             PREFIX_UTXO, PREFIX_ADDRESS, utxoSetHash, utxoSetInfo);
+    
     // Remove spent UTXOs
     for (const auto& input : tx.getInputs()) {
-        std::string utxoKey = makeKey(PREFIX_UTXO, input.txHash + ":" + std::to_string(input.outputIndex));
-        batch.Delete(utxoKey);
+        std::string spentAddress;
+        double spentAmount;
+        utxoUpdate.spend(makeKey(PREFIX_UTXO, input.txHash + ":" + std::to_string(input.outputIndex)),
+                         spentAddress, spentAmount);
     }
     
     // Add new UTXOs
@@ -661,15 +1346,24 @@ bool Database::updateUtxoSet(const Transaction& tx, size_t blockHeight) {
         utxo["script"] = output.script;
         utxo["block_height"] = blockHeight;
         
-        std::string utxoKey = makeKey(PREFIX_UTXO, tx.getHash() + ":" + std::to_string(i));
-        batch.Put(utxoKey, utxo.dump());
-        
-        // Also index by address for balance lookups
-        std::string addrKey = makeKey(PREFIX_ADDRESS, output.address + ":" + tx.getHash() + ":" + std::to_string(i));
-        batch.Put(addrKey, utxo.dump());
+        utxoUpdate.create(makeKey(PREFIX_UTXO, tx.getHash() + ":" + std::to_string(i)), utxo.dump(),
+                          output.address, output.amount);
     }
     
-    return db->Write(writeOptions, &batch).ok();
+    // Outside saveBlock there is no per-height summary or undo data, only the running state
+    utxoSetInfo.hash = utxoSetHash.digest();
+    batch.Put(makeKey(PREFIX_CONFIG, "utxo_set_state"), utxoSetStateRecord(utxoSetHash, utxoSetInfo));
+    
+    if (!db->Write(writeOptions, &batch).ok()) {
+        return false;
+    }
+    
+    if (compactionScheduler) {
+        for (const auto& key : utxoUpdate.deletedKeys()) {
+            compactionScheduler->recordDeletion(key);
+        }
+    }
+    return true;
 }
 
 bool Database::saveTraceabilityRecord(const Transaction& tx, size_t blockHeight) {
@@ -684,12 +1378,80 @@ bool Database::saveTraceabilityRecord(const Transaction& tx, size_t blockHeight)
     return put(makeKey(PREFIX_TRACE, tx.getHash()), trace.dump());
 }
 
+bool Database::getTraceabilityRecord(const std::string& txHash, TraceabilityRecord& record) const {
+    std::string data;
+    if (!get(makeKey(PREFIX_TRACE, txHash), data)) return false;
+    
+    try {
+        json trace = json::parse(data);
+        record.txHash = trace.value("tx_hash", txHash);
+        record.prevTxHash = trace.value("prev_tx_hash", "");
+        record.referencedAmount = trace.value("referenced_amount", 0.0);
+        record.blockHeight = trace.value("block_height", 0u);
+        record.timestamp = trace.value("timestamp", static_cast<uint64_t>(0));
+        return true;
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Corrupt traceability record for " + txHash + ": " + std::string(e.what()));
+        return false;
+    }
+}
+
+bool Database::getTransactionLocation(const std::string& txHash, std::string& blockHash, uint32_t& blockHeight) const {
+    std::string data;
+    if (!get(makeKey(PREFIX_TX_BLOCK, txHash), data)) return false;
+    
+    try {
+        json mapping = json::parse(data);
+        blockHash = mapping["block_hash"].get<std::string>();
+        blockHeight = mapping["block_height"].get<uint32_t>();
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
 std::vector<Transaction> Database::getTransactionsByBlockHash(const std::string& blockHash) const {
     std::vector<Transaction> transactions;
     
     if (!db) return transactions;
     
-    // Iterate through all tx_block mappings
+    // The block record lists its transactions in order; fetch those directly
+    std::string blockData;
+    if (get(makeKey(PREFIX_BLOCK, blockHash), blockData)) {
+        std::pmr::monotonic_buffer_resource blockArena;
+        DecodeArena::Scope blockScope(&blockArena);
+        
+        try {
+            arena_json block = arena_json::parse(blockData);
+            if (block.contains("tx_hashes")) {
+                const auto& txHashes = block["tx_hashes"];
+                transactions.reserve(txHashes.size());
+                
+                std::vector<char> scratch(TX_DECODE_SCRATCH_BYTES);
+                std::pmr::monotonic_buffer_resource txArena(scratch.data(), scratch.size());
+                std::string txData;
+                for (const auto& txHash : txHashes) {
+                    const std::string& hash = txHash.get_ref<const std::string&>();
+                    if (!get(makeKey(PREFIX_TX, hash), txData)) {
+                        LOG_DATABASE(LogLevel::WARNING, "Block " + blockHash + " lists missing transaction " + hash);
+                        continue;
+                    }
+                    {
+                        DecodeArena::Scope txScope(&txArena);
+                        arena_json tx = arena_json::parse(txData);
+                        transactions.push_back(transactionFromJson(tx));
+                    }
+                    txArena.release();
+                }
+                return transactions;
+            }
+        } catch (const std::exception& e) {
+            LOG_DATABASE(LogLevel::ERROR, "Failed to load transactions of block " + blockHash + ": " + std::string(e.what()));
+            transactions.clear();
+        }
+    }
+    
+    // Records without a tx list: fall back to scanning every tx -> block mapping
     std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
     
     for (it->Seek(PREFIX_TX_BLOCK); it->Valid(); it->Next()) {
@@ -713,26 +1475,46 @@ std::vector<Transaction> Database::getTransactionsByBlockHash(const std::string&
     return transactions;
 }
 
-std::vector<TransactionInput> Database::getTransactionInputs(const std::string& txHash) const {
+std::shared_ptr<const Transaction> Database::getTransactionShared(const std::string& txHash) const {
+    std::shared_ptr<const Transaction> cached;
+    if (decodedTransactions.get(txHash, cached)) {
+        return cached;
+    }
+    
+    uint64_t generation = decodedTransactions.generation();
     std::string txData;
-    if (get(makeKey(PREFIX_TX, txHash), txData)) {
-        Transaction tx = deserializeTransaction(txData);
-        return tx.getInputs();
+    if (!get(makeKey(PREFIX_TX, txHash), txData)) {
+        return nullptr;
     }
-    return {};
+    auto tx = std::make_shared<const Transaction>(deserializeTransaction(txData));
+    tx->getHash();
+    decodedTransactions.putIfUnchanged(txHash, tx, decodedSize(*tx), generation);
+    return tx;
+}
+
+std::vector<TransactionInput> Database::getTransactionInputs(const std::string& txHash) const {
+    std::shared_ptr<const Transaction> tx = getTransactionShared(txHash);
+    return tx ? tx->getInputs() : std::vector<TransactionInput>();
 }
 
 std::vector<TransactionOutput> Database::getTransactionOutputs(const std::string& txHash) const {
-    std::string txData;
-    if (get(makeKey(PREFIX_TX, txHash), txData)) {
-        Transaction tx = deserializeTransaction(txData);
-        return tx.getOutputs();
-    }
-    return {};
+    std::shared_ptr<const Transaction> tx = getTransactionShared(txHash);
+    return tx ? tx->getOutputs() : std::vector<TransactionOutput>();
+}
+
+DecodedCacheStats Database::getDecodedCacheStats() const {
+    DecodedCacheStats stats;
+    stats.blocks = decodedBlocks.getStats();
+    stats.transactions = decodedTransactions.getStats();
+    return stats;
 }
 
 // UTXO operations
+// Single-entry changes go through the same staged update as saveBlock, so the set
+// hash, count, amount and addr: index stay in step with utxo:
 bool Database::storeUTXO(const std::string& txHash, uint32_t outputIndex, const TransactionOutput& output, uint32_t blockHeight) {
+    if (!db) return false;
+    
     json utxo;
     utxo["tx_hash"] = txHash;
     utxo["output_index"] = outputIndex;
@@ -741,8 +1523,20 @@ bool Database::storeUTXO(const std::string& txHash, uint32_t outputIndex, const
     utxo["script"] = output.script;
     utxo["block_height"] = blockHeight;
     
-    std::string key = makeKey(PREFIX_UTXO, txHash + ":" + std::to_string(outputIndex));
-    return put(key, utxo.dump());
+    std::lock_guard<std::mutex> utxoLock(utxoSetMutex);
+    leveldb::WriteBatch batch;
+    UtxoSetHash utxoSetHash;
+    UtxoSetInfo utxoSetInfo;
+    loadUtxoSetState(utxoSetHash, utxoSetInfo);
+    UtxoSetUpdate utxoUpdate(batch, [this](const std::string& key, std::string& value) { return get(key, value); },
+                             PREFIX_UTXO, PREFIX_ADDRESS, utxoSetHash, utxoSetInfo);
+    
+    utxoUpdate.create(makeKey(PREFIX_UTXO, txHash + ":" + std::to_string(outputIndex)), utxo.dump(),
+                      output.address, output.amount);
+    
+    utxoSetInfo.hash = utxoSetHash.digest();
+    batch.Put(makeKey(PREFIX_CONFIG, "utxo_set_state"), utxoSetStateRecord(utxoSetHash, utxoSetInfo));
+    return db->Write(writeOptions, &batch).ok();
 }
 
 bool Database::getUTXO(const std::string& txHash, uint32_t outputIndex, TransactionOutput& output) const {
@@ -756,6 +1550,7 @@ bool Database::getUTXO(const std::string& txHash, uint32_t outputIndex, Transact
         output.address = j["address"].get<std::string>();
         output.amount = j["amount"].get<double>();
         output.script = j["script"].get<std::string>();
+        output.classifyScript();
         return true;
     } catch (...) {
         return false;
@@ -763,17 +1558,140 @@ bool Database::getUTXO(const std::string& txHash, uint32_t outputIndex, Transact
 }
 
 bool Database::deleteUTXO(const std::string& txHash, uint32_t outputIndex) {
-    std::string key = makeKey(PREFIX_UTXO, txHash + ":" + std::to_string(outputIndex));
-    return del(key);
-}
-
-std::vector<TransactionOutput> Database::getUTXOsByAddress(const std::string& address) const {
-    std::vector<TransactionOutput> utxos;
+    if (!db) return false;
     
-    if (!db) return utxos;
+    std::lock_guard<std::mutex> utxoLock(utxoSetMutex);
+    leveldb::WriteBatch batch;
+    UtxoSetHash utxoSetHash;
+    UtxoSetInfo utxoSetInfo;
+    loadUtxoSetState(utxoSetHash, utxoSetInfo);
+    UtxoSetUpdate utxoUpdate(batch, [this](const std::string& key, std::string& value) { return get(key, value); },
+                             PREFIX_UTXO, PREFIX_ADDRESS, utxoSetHash, utxoSetInfo);
     
-    std::string prefix = makeKey(PREFIX_ADDRESS, address + ":");
-    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
+    std::string spentAddress;
+    double spentAmount;
+    if (!utxoUpdate.spend(makeKey(PREFIX_UTXO, txHash + ":" + std::to_string(outputIndex)), spentAddress, spentAmount)) {
+        // Nothing stored: deleting is a no-op, as before, and the state is unchanged
+        return true;
+    }
+    
+    utxoSetInfo.hash = utxoSetHash.digest();
+    batch.Put(makeKey(PREFIX_CONFIG, "utxo_set_state"), utxoSetStateRecord(utxoSetHash, utxoSetInfo));
+    if (!db->Write(writeOptions, &batch).ok()) {
+        return false;
+    }
+    
+    if (compactionScheduler) {
+        for (const auto& key : utxoUpdate.deletedKeys()) {
+            compactionScheduler->recordDeletion(key);
+        }
+    }
+    return true;
+}
+
+// UTXO set hash
+std::string Database::utxoSetInfoToJson(const UtxoSetInfo& info) const {
+    json j;
+    j["height"] = info.height;
+    j["hash"] = info.hash;
+    j["txout_count"] = info.txoutCount;
+    j["total_amount"] = info.totalAmount;
+    return j.dump();
+}
+
+bool Database::loadUtxoSetState(UtxoSetHash& setHash, UtxoSetInfo& info) const {
+    setHash.clear();
+    info = UtxoSetInfo();
+    
+    // A missing or unreadable record is reported as missing; open() rescans utxo: then
+    std::string state;
+    if (!getConfigValue("utxo_set_state", state)) {
+        return false;
+    }
+    
+    try {
+        json j = json::parse(state);
+        if (j["total_amount"].is_number_integer() && setHash.deserialize(j["lanes"].get<std::string>())) {
+            info.height = j["height"].get<uint32_t>();
+            info.txoutCount = j["txout_count"].get<uint64_t>();
+            info.totalAmount = j["total_amount"].get<Amount>();
+            info.hash = setHash.digest();
+            return true;
+        }
+    } catch (...) {
+    }
+    setHash.clear();
+    return false;
+}
+
+// The running state, which also reflects deleted blocks and updateUtxoSet calls
+bool Database::getUtxoSetInfo(UtxoSetInfo& info) const {
+    UtxoSetHash setHash;
+    return loadUtxoSetState(setHash, info);
+}
+
+bool Database::getUtxoSetInfo(uint32_t height, UtxoSetInfo& info) const {
+    std::string data;
+    if (!get(makeKey(PREFIX_UTXO_STATS, height), data)) {
+        return false;
+    }
+    
+    try {
+        json j = json::parse(data);
+        info.height = j["height"].get<uint32_t>();
+        info.hash = j["hash"].get<std::string>();
+        info.txoutCount = j["txout_count"].get<uint64_t>();
+        info.totalAmount = j["total_amount"].get<Amount>();
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool Database::rebuildUtxoSetHash() {
+    if (!db) return false;
+    
+    std::lock_guard<std::mutex> utxoLock(utxoSetMutex);
+    UtxoSetHash setHash;
+    UtxoSetInfo info;
+    
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
+    for (it->Seek(PREFIX_UTXO); it->Valid(); it->Next()) {
+        if (!it->key().starts_with(PREFIX_UTXO)) break;
+        
+        std::string key = it->key().ToString();
+        std::string value = it->value().ToString();
+        try {
+            Amount amount = 0;
+            toAmount(json::parse(value)["amount"].get<double>(), amount);
+            info.totalAmount += amount;
+        } catch (...) {
+            continue;
+        }
+        setHash.add(key, value);
+        info.txoutCount++;
+    }
+    
+    std::string height;
+    getConfigValue("latest_block_height", height);
+    info.height = height.empty() ? 0 : static_cast<uint32_t>(std::stoul(height));
+    info.hash = setHash.digest();
+    
+    leveldb::WriteBatch batch;
+    batch.Put(makeKey(PREFIX_CONFIG, "utxo_set_state"), utxoSetStateRecord(setHash, info));
+    batch.Put(makeKey(PREFIX_UTXO_STATS, info.height), utxoSetInfoToJson(info));
+    
+    LOG_DATABASE(LogLevel::INFO, "Rebuilt UTXO set hash: " + std::to_string(info.txoutCount) + " outputs, hash " + info.hash);
+    return db->Write(writeOptions, &batch).ok();
+}
+
+std::vector<TransactionOutput> Database::getUTXOsByAddress(const std::string& address) const {
+    std::vector<TransactionOutput> utxos;
+    
+    if (!db) return utxos;
+    
+    std::string prefix = makeKey(PREFIX_ADDRESS, address + ":");
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
     
     for (it->Seek(prefix); it->Valid(); it->Next()) {
         std::string key = it->key().ToString();
@@ -785,6 +1703,7 @@ std::vector<TransactionOutput> Database::getUTXOsByAddress(const std::string& ad
             output.address = j["address"].get<std::string>();
             output.amount = j["amount"].get<double>();
             output.script = j["script"].get<std::string>();
+            output.classifyScript();
             utxos.push_back(output);
         } catch (...) {
             continue;
@@ -794,6 +1713,587 @@ std::vector<TransactionOutput> Database::getUTXOsByAddress(const std::string& ad
     return utxos;
 }
 
+// Visits every addr: entry of each key prefix, given as sorted unique
+// "addr:<address>:" strings. Tasks cover contiguous runs of prefixes with one
+// iterator each; within a run the iterator only seeks when the next prefix lies
+// ahead of where the previous one ended, so dense address sets read sequentially.
+template <typename Visit>
+static void sweepAddressIndex(leveldb::DB* db, const leveldb::ReadOptions& options,
+                              const std::vector<std::string>& sortedPrefixes, Visit visit) {
+    ThreadPool::shared().parallelFor(sortedPrefixes.size(), ADDRESS_SWEEP_GRAIN, [&](size_t begin, size_t end) {
+        std::unique_ptr<leveldb::Iterator> it(db->NewIterator(options));
+        std::vector<char> scratch(TX_DECODE_SCRATCH_BYTES);
+        std::pmr::monotonic_buffer_resource arena(scratch.data(), scratch.size());
+        
+        bool positioned = false;
+        for (size_t i = begin; i < end; i++) {
+            const std::string& prefix = sortedPrefixes[i];
+            if (!positioned || (it->Valid() && it->key().compare(prefix) < 0)) {
+                it->Seek(prefix);
+                positioned = true;
+            }
+            for (; it->Valid() && it->key().starts_with(prefix); it->Next()) {
+                try {
+                    DecodeArena::Scope scope(&arena);
+                    leveldb::Slice value = it->value();
+                    arena_json utxo = arena_json::parse(value.data(), value.data() + value.size());
+                    visit(i, it->key(), utxo);
+                } catch (...) {
+                    // Skip unreadable entries, as getUTXOsByAddress does
+                }
+                arena.release();
+            }
+        }
+    });
+}
+
+// Sorted unique addr: prefixes for a query, and for each input address the slot of its prefix
+static std::vector<std::string> addressSweepPrefixes(const std::string& prefixBase,
+                                                     const std::vector<std::string>& addresses,
+                                                     std::vector<size_t>& slotOfAddress) {
+    // Sort the full prefixes, not the addresses: "A1:" orders before "A:" since '1' < ':'
+    std::vector<std::string> prefixes;
+    prefixes.reserve(addresses.size());
+    for (const auto& address : addresses) {
+        prefixes.push_back(prefixBase + address + ":");
+    }
+    std::vector<std::string> sorted = prefixes;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    
+    slotOfAddress.resize(addresses.size());
+    for (size_t i = 0; i < prefixes.size(); i++) {
+        slotOfAddress[i] = std::lower_bound(sorted.begin(), sorted.end(), prefixes[i]) - sorted.begin();
+    }
+    return sorted;
+}
+
+std::vector<double> Database::getAddressBalances(const std::vector<std::string>& addresses) const {
+    std::vector<double> balances(addresses.size(), 0.0);
+    if (!db || addresses.empty()) return balances;
+    
+    // One snapshot so every address is read at the same chain state
+    const leveldb::Snapshot* dbSnapshot = db->GetSnapshot();
+    leveldb::ReadOptions snapOptions = readOptions;
+    snapOptions.snapshot = dbSnapshot;
+    
+    try {
+        std::vector<size_t> slotOfAddress;
+        std::vector<std::string> prefixes = addressSweepPrefixes(PREFIX_ADDRESS, addresses, slotOfAddress);
+        std::vector<double> totals(prefixes.size(), 0.0);
+        
+        sweepAddressIndex(db.get(), snapOptions, prefixes, [&](size_t slot, const leveldb::Slice&, arena_json& utxo) {
+            totals[slot] += utxo["amount"].get<double>();
+        });
+        
+        for (size_t i = 0; i < addresses.size(); i++) {
+            balances[i] = totals[slotOfAddress[i]];
+        }
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Exception reading address balances: " + std::string(e.what()));
+    }
+    
+    db->ReleaseSnapshot(dbSnapshot);
+    return balances;
+}
+
+std::vector<std::vector<AddressUtxo>> Database::getUTXOsByAddresses(const std::vector<std::string>& addresses) const {
+    std::vector<std::vector<AddressUtxo>> results(addresses.size());
+    if (!db || addresses.empty()) return results;
+    
+    const leveldb::Snapshot* dbSnapshot = db->GetSnapshot();
+    leveldb::ReadOptions snapOptions = readOptions;
+    snapOptions.snapshot = dbSnapshot;
+    
+    try {
+        std::vector<size_t> slotOfAddress;
+        std::vector<std::string> prefixes = addressSweepPrefixes(PREFIX_ADDRESS, addresses, slotOfAddress);
+        std::vector<std::vector<AddressUtxo>> found(prefixes.size());
+        
+        sweepAddressIndex(db.get(), snapOptions, prefixes, [&](size_t slot, const leveldb::Slice&, arena_json& utxo) {
+            AddressUtxo entry;
+            entry.txHash = takeString(utxo["tx_hash"]);
+            entry.outputIndex = utxo["output_index"].get<uint32_t>();
+            entry.output.address = takeString(utxo["address"]);
+            entry.output.amount = utxo["amount"].get<double>();
+            entry.output.script = takeString(utxo["script"]);
+            entry.output.classifyScript();
+            entry.blockHeight = utxo.value("block_height", 0u);
+            found[slot].push_back(std::move(entry));
+        });
+        
+        // Duplicate input addresses share one result slot: every occurrence but the
+        // last gets a copy, and the last takes the slot by move
+        std::vector<size_t> lastUse(prefixes.size());
+        for (size_t i = 0; i < addresses.size(); i++) {
+            lastUse[slotOfAddress[i]] = i;
+        }
+        for (size_t i = 0; i < addresses.size(); i++) {
+            size_t slot = slotOfAddress[i];
+            if (lastUse[slot] == i) {
+                results[i] = std::move(found[slot]);
+            } else {
+                results[i] = found[slot];
+            }
+        }
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Exception reading address UTXOs: " + std::string(e.what()));
+    }
+    
+    db->ReleaseSnapshot(dbSnapshot);
+    return results;
+}
+
+// Address history index
+// Keys are hist:<address>:<height>:<position>, zero-padded so that LevelDB order is
+// chain order; a cursor is the <height>:<position> suffix of the last entry returned.
+std::string Database::makeHistoryKey(const std::string& address, uint32_t height, uint32_t position) const {
+    std::ostringstream oss;
+    oss << PREFIX_HISTORY << address << ":" << std::setw(10) << std::setfill('0') << height
+        << ":" << std::setw(6) << std::setfill('0') << position;
+    return oss.str();
+}
+
+std::string Database::historyEntryToJson(const std::string& txHash, uint32_t height, uint32_t position,
+                                         double sent, double received) const {
+    json entry;
+    entry["tx_hash"] = txHash;
+    entry["block_height"] = height;
+    entry["position"] = position;
+    entry["sent"] = sent;
+    entry["received"] = received;
+    return entry.dump();
+}
+
+std::vector<AddressHistoryEntry> Database::getAddressHistory(const std::string& address, const std::string& cursor,
+                                                             size_t limit, bool reverse, std::string& nextCursor) const {
+    std::vector<AddressHistoryEntry> history;
+    nextCursor.clear();
+    
+    if (!db || limit == 0) return history;
+    
+    std::string prefix = PREFIX_HISTORY + address + ":";
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
+    
+    if (!reverse) {
+        it->Seek(prefix + cursor);
+        // The cursor names the last entry already returned
+        if (!cursor.empty() && it->Valid() && it->key().ToString() == prefix + cursor) {
+            it->Next();
+        }
+    } else {
+        // '~' sorts after every digit, so this lands just past the address's last entry
+        it->Seek(cursor.empty() ? prefix + "~" : prefix + cursor);
+        if (it->Valid()) {
+            it->Prev();
+        } else {
+            it->SeekToLast();
+        }
+    }
+    
+    for (; it->Valid() && history.size() < limit; reverse ? it->Prev() : it->Next()) {
+        if (!it->key().starts_with(prefix)) break;
+        
+        try {
+            json j = json::parse(it->value().ToString());
+            AddressHistoryEntry entry;
+            entry.txHash = j["tx_hash"].get<std::string>();
+            entry.blockHeight = j["block_height"].get<uint32_t>();
+            entry.position = j["position"].get<uint32_t>();
+            entry.sent = j["sent"].get<double>();
+            entry.received = j["received"].get<double>();
+            history.push_back(entry);
+            nextCursor = it->key().ToString().substr(prefix.size());
+        } catch (...) {
+            continue;
+        }
+    }
+    
+    // An empty cursor tells the caller there are no more pages
+    if (history.size() < limit) {
+        nextCursor.clear();
+    }
+    
+    return history;
+}
+
+bool Database::rebuildAddressHistory() {
+    if (!db) return false;
+    
+    try {
+        // Balances seeded by a snapshot import have no block to replay when the base
+        // block is not stored: keep them and carry them forward
+        std::unordered_map<std::string, Amount> balances;
+        std::set<std::string> seededKeys;
+        uint32_t snapshotHeight = 0;
+        std::string snapshotHash, snapshotBlock, seeded;
+        if (getSnapshotBase(snapshotHeight, snapshotHash) &&
+            !get(makeKey(PREFIX_BLOCK_HEIGHT, snapshotHeight), snapshotBlock) &&
+            get(makeKey(PREFIX_BALANCE_BLOCK, snapshotHeight), seeded)) {
+            seededKeys.insert(makeKey(PREFIX_BALANCE_BLOCK, snapshotHeight));
+            for (const auto& address : json::parse(seeded)) {
+                const std::string& name = address.get_ref<const std::string&>();
+                std::string entryData;
+                if (get(balanceKey(PREFIX_BALANCE, name, snapshotHeight), entryData)) {
+                    seededKeys.insert(balanceKey(PREFIX_BALANCE, name, snapshotHeight));
+                    balances[name] = json::parse(entryData)["balance"].get<Amount>();
+                }
+            }
+        }
+        
+        // Drop the existing history and balance indexes first
+        leveldb::WriteBatch cleanup;
+        std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
+        for (const std::string* prefix : {&PREFIX_HISTORY, &PREFIX_BALANCE, &PREFIX_BALANCE_BLOCK}) {
+            for (it->Seek(*prefix); it->Valid() && it->key().starts_with(*prefix); it->Next()) {
+                if (seededKeys.count(it->key().ToString())) continue;
+                cleanup.Delete(it->key());
+            }
+        }
+        if (!db->Write(writeOptions, &cleanup).ok()) {
+            return false;
+        }
+        
+        // Replay blocks in height order; blkh: keys are zero-padded so iteration is chain order.
+        // Running balances are carried in memory instead of read back per block.
+        leveldb::WriteBatch batch;
+        uint32_t blocksIndexed = 0;
+        
+        for (it->Seek(PREFIX_BLOCK_HEIGHT); it->Valid() && it->key().starts_with(PREFIX_BLOCK_HEIGHT); it->Next()) {
+            std::string blockHash = it->value().ToString();
+            std::string blockData;
+            if (!get(makeKey(PREFIX_BLOCK, blockHash), blockData)) continue;
+            
+            json blockJson = json::parse(blockData);
+            uint32_t height = blockJson["index"].get<uint32_t>();
+            const json& txHashes = blockJson["tx_hashes"];
+            std::map<std::string, Amount> balanceChanges;
+            
+            for (uint32_t position = 0; position < txHashes.size(); position++) {
+                std::string txHash = txHashes[position].get<std::string>();
+                std::string txData;
+                if (!get(makeKey(PREFIX_TX, txHash), txData)) continue;
+                
+                json txJson = json::parse(txData);
+                std::map<std::string, std::pair<double, double>> touched;
+                
+                // Spent outputs are gone from utxo:, so resolve senders from the funding transaction
+                for (const auto& inp : txJson["inputs"]) {
+                    std::string fundingData;
+                    if (!get(makeKey(PREFIX_TX, inp["tx_hash"].get<std::string>()), fundingData)) continue;
+                    
+                    json funding = json::parse(fundingData);
+                    uint32_t outputIndex = inp["output_index"].get<uint32_t>();
+                    if (outputIndex < funding["outputs"].size()) {
+                        const json& spent = funding["outputs"][outputIndex];
+                        touched[spent["address"].get<std::string>()].first += spent["amount"].get<double>();
+                    }
+                }
+                for (const auto& out : txJson["outputs"]) {
+                    touched[out["address"].get<std::string>()].second += out["amount"].get<double>();
+                }
+                
+                for (const auto& entry : touched) {
+                    batch.Put(makeHistoryKey(entry.first, height, position),
+                             historyEntryToJson(txHash, height, position, entry.second.first, entry.second.second));
+                    
+                    Amount sent = 0, received = 0;
+                    toAmount(entry.second.first, sent);
+                    toAmount(entry.second.second, received);
+                    balanceChanges[entry.first] += received - sent;
+                }
+            }
+            
+            json touchedAddresses = json::array();
+            for (const auto& change : balanceChanges) {
+                Amount& balance = balances[change.first];
+                balance += change.second;
+                batch.Put(balanceKey(PREFIX_BALANCE, change.first, height), balanceEntryToJson(change.second, balance));
+                touchedAddresses.push_back(change.first);
+            }
+            if (!balanceChanges.empty()) {
+                batch.Put(makeKey(PREFIX_BALANCE_BLOCK, height), touchedAddresses.dump());
+            }
+            
+            // Flush periodically to keep the batch bounded
+            if (++blocksIndexed % 1000 == 0) {
+                if (!db->Write(writeOptions, &batch).ok()) return false;
+                batch.Clear();
+                LOG_DATABASE(LogLevel::INFO, "Address history rebuild: " + std::to_string(blocksIndexed) + " blocks indexed");
+            }
+        }
+        
+        if (!db->Write(writeOptions, &batch).ok()) {
+            return false;
+        }
+        
+        LOG_DATABASE(LogLevel::INFO, "Rebuilt address history index over " + std::to_string(blocksIndexed) + " blocks");
+        return true;
+        
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Exception rebuilding address history: " + std::string(e.what()));
+        return false;
+    }
+}
+
+bool Database::getBlockFilter(uint32_t height, BlockFilter& filter, Hash256& header) const {
+    std::string record;
+    if (!get(makeKey(PREFIX_FILTER, height), record)) {
+        return false;
+    }
+    return parseFilterRecord(record, filter, header);
+}
+
+std::vector<uint32_t> Database::matchBlockFilters(const std::vector<std::string>& elements,
+                                                  uint32_t startHeight, uint32_t endHeight) const {
+    std::vector<uint32_t> matches;
+    if (!db || elements.empty() || startHeight > endHeight) return matches;
+    
+    try {
+        // cflt: keys are zero-padded, so one forward scan visits the range in height order
+        std::string endKey = makeKey(PREFIX_FILTER, endHeight);
+        std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
+        BlockFilter filter;
+        Hash256 header;
+        
+        for (it->Seek(makeKey(PREFIX_FILTER, startHeight));
+             it->Valid() && it->key().starts_with(PREFIX_FILTER) && it->key().compare(endKey) <= 0; it->Next()) {
+            if (!parseFilterRecord(it->value().ToString(), filter, header)) continue;
+            if (filter.matchAny(elements)) {
+                std::string key = it->key().ToString();
+                matches.push_back(static_cast<uint32_t>(std::stoul(key.substr(PREFIX_FILTER.size()))));
+            }
+        }
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Exception matching block filters: " + std::string(e.what()));
+    }
+    
+    return matches;
+}
+
+bool Database::buildStoredBlockFilter(const std::string& blockHash, BlockFilter& filter) const {
+    std::string blockData;
+    if (!get(makeKey(PREFIX_BLOCK, blockHash), blockData)) return false;
+    
+    json blockJson = json::parse(blockData);
+    std::vector<std::string> elements;
+    for (const auto& txHash : blockJson["tx_hashes"]) {
+        std::string txData;
+        if (!get(makeKey(PREFIX_TX, txHash.get<std::string>()), txData)) continue;
+        appendFilterElements(deserializeTransaction(txData), elements);
+    }
+    filter = BlockFilter::build(blockHash, std::move(elements));
+    return true;
+}
+
+// Stages the filters of the stored blocks above the last stored filter, up to and
+// including height, and returns the filter header at height. The chain starts from
+// the zero header at genesis or above a snapshot base whose block is not stored,
+// as it does in rebuildBlockFilters().
+bool Database::backfillBlockFilters(uint32_t height, leveldb::WriteBatch& batch, Hash256& header) const {
+    header = Hash256();
+    uint32_t startHeight = 0;
+    
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
+    it->Seek(makeKey(PREFIX_FILTER, height));
+    if (it->Valid()) {
+        it->Prev();
+    } else {
+        it->SeekToLast();
+    }
+    if (it->Valid() && it->key().starts_with(PREFIX_FILTER)) {
+        BlockFilter filter;
+        if (!parseFilterRecord(it->value().ToString(), filter, header)) return false;
+        startHeight = static_cast<uint32_t>(std::stoul(it->key().ToString().substr(PREFIX_FILTER.size()))) + 1;
+    }
+    
+    uint32_t snapshotHeight = 0;
+    std::string snapshotHash;
+    std::string snapshotBlock;
+    if (getSnapshotBase(snapshotHeight, snapshotHash) && snapshotHeight >= startHeight && snapshotHeight <= height &&
+        !get(makeKey(PREFIX_BLOCK_HEIGHT, snapshotHeight), snapshotBlock)) {
+        header = Hash256();
+        startHeight = snapshotHeight + 1;
+    }
+    
+    if (startHeight <= height) {
+        LOG_DATABASE(LogLevel::WARNING, "No block filters from height " + std::to_string(startHeight) +
+                     " to " + std::to_string(height) + ", building them");
+    }
+    for (uint64_t h = startHeight; h <= height; h++) {
+        std::string blockHash;
+        BlockFilter filter;
+        if (!get(makeKey(PREFIX_BLOCK_HEIGHT, static_cast<uint32_t>(h)), blockHash) ||
+            !buildStoredBlockFilter(blockHash, filter)) {
+            LOG_DATABASE(LogLevel::ERROR, "No stored block at height " + std::to_string(h) + " to build its filter");
+            return false;
+        }
+        header = BlockFilter::computeHeader(filter.getFilterHash(), header);
+        batch.Put(makeKey(PREFIX_FILTER, static_cast<uint32_t>(h)), filterRecord(filter, header));
+    }
+    return true;
+}
+
+bool Database::rebuildBlockFilters() {
+    if (!db) return false;
+    
+    try {
+        // Replay blocks in height order so each header chains to the one before it
+        leveldb::WriteBatch batch;
+        std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
+        Hash256 previousHeader;
+        uint32_t blocksIndexed = 0;
+        
+        for (it->Seek(PREFIX_BLOCK_HEIGHT); it->Valid() && it->key().starts_with(PREFIX_BLOCK_HEIGHT); it->Next()) {
+            std::string key = it->key().ToString();
+            uint32_t height = static_cast<uint32_t>(std::stoul(key.substr(PREFIX_BLOCK_HEIGHT.size())));
+            BlockFilter filter;
+            if (!buildStoredBlockFilter(it->value().ToString(), filter)) continue;
+            
+            previousHeader = BlockFilter::computeHeader(filter.getFilterHash(), previousHeader);
+            batch.Put(makeKey(PREFIX_FILTER, height), filterRecord(filter, previousHeader));
+            
+            // Flush periodically to keep the batch bounded
+            if (++blocksIndexed % 1000 == 0) {
+                if (!db->Write(writeOptions, &batch).ok()) return false;
+                batch.Clear();
+                LOG_DATABASE(LogLevel::INFO, "Block filter rebuild: " + std::to_string(blocksIndexed) + " blocks indexed");
+            }
+        }
+        
+        if (!db->Write(writeOptions, &batch).ok()) {
+            return false;
+        }
+        
+        LOG_DATABASE(LogLevel::INFO, "Rebuilt block filters over " + std::to_string(blocksIndexed) + " blocks");
+        return true;
+        
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Exception rebuilding block filters: " + std::string(e.what()));
+        return false;
+    }
+}
+
+// Running balances chain from the latest entry below this height, so blocks must be
+// saved in height order, as they are
+// netChanges receives the change to each address's current balance: this block's
+// changes less those of any block it replaces
+void Database::writeBalanceChanges(leveldb::WriteBatch& batch, uint32_t height,
+                                   const std::map<std::string, Amount>& changes,
+                                   std::map<std::string, Amount>& netChanges) const {
+    // A block previously saved at this height is being replaced: drop its entries
+    std::string replacedData;
+    if (get(makeKey(PREFIX_BALANCE_BLOCK, height), replacedData)) {
+        for (const auto& address : json::parse(replacedData)) {
+            const std::string& name = address.get_ref<const std::string&>();
+            std::string entryData;
+            if (get(balanceKey(PREFIX_BALANCE, name, height), entryData)) {
+                netChanges[name] -= json::parse(entryData)["delta"].get<Amount>();
+            }
+            if (!changes.count(name)) {
+                batch.Delete(balanceKey(PREFIX_BALANCE, name, height));
+            }
+        }
+    }
+    
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
+    json touched = json::array();
+    for (const auto& change : changes) {
+        Amount previous;
+        balanceBefore(it.get(), PREFIX_BALANCE, change.first, height, previous);
+        batch.Put(balanceKey(PREFIX_BALANCE, change.first, height), balanceEntryToJson(change.second, previous + change.second));
+        touched.push_back(change.first);
+        netChanges[change.first] += change.second;
+    }
+    
+    if (changes.empty()) {
+        batch.Delete(makeKey(PREFIX_BALANCE_BLOCK, height));
+    } else {
+        batch.Put(makeKey(PREFIX_BALANCE_BLOCK, height), touched.dump());
+    }
+}
+
+// One reverse seek: O(log n) regardless of how far back the height is
+bool Database::getAddressBalanceAt(const std::string& address, uint32_t height, double& balance) const {
+    if (!db) return false;
+    
+    try {
+        // Below a snapshot base there are no running balances unless the block is stored
+        uint32_t snapshotHeight = 0;
+        std::string snapshotHash;
+        std::string blockHash;
+        if (getSnapshotBase(snapshotHeight, snapshotHash) && height < snapshotHeight &&
+            !get(makeKey(PREFIX_BLOCK_HEIGHT, height), blockHash)) {
+            LOG_DATABASE(LogLevel::WARNING, "No historical balance below snapshot base height " +
+                         std::to_string(snapshotHeight));
+            return false;
+        }
+        
+        std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
+        Amount units;
+        balanceBefore(it.get(), PREFIX_BALANCE, address, static_cast<uint64_t>(height) + 1, units);
+        balance = amountToDouble(units);
+        return true;
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Exception reading historical balance: " + std::string(e.what()));
+        return false;
+    }
+}
+
+// Rich list
+bool Database::rebuildRichList() {
+    if (!db || !richList) return false;
+    
+    try {
+        // Current balances are the sum of each address's unspent outputs
+        std::unordered_map<std::string, Amount> balances;
+        std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
+        for (it->Seek(PREFIX_ADDRESS); it->Valid() && it->key().starts_with(PREFIX_ADDRESS); it->Next()) {
+            try {
+                json utxo = json::parse(it->value().ToString());
+                Amount amount = 0;
+                toAmount(utxo["amount"].get<double>(), amount);
+                balances[utxo["address"].get<std::string>()] += amount;
+            } catch (...) {
+                continue;
+            }
+        }
+        
+        leveldb::WriteBatch batch;
+        for (it->Seek(PREFIX_RICH); it->Valid() && it->key().starts_with(PREFIX_RICH); it->Next()) {
+            batch.Delete(it->key());
+        }
+        for (const auto& entry : balances) {
+            if (entry.second > 0) {
+                batch.Put(richList->key(entry.first, entry.second), leveldb::Slice());
+            }
+        }
+        batch.Put(makeKey(PREFIX_CONFIG, "rich_list_ready"), "1");
+        if (!db->Write(writeOptions, &batch).ok()) {
+            return false;
+        }
+        
+        LOG_DATABASE(LogLevel::INFO, "Rebuilt rich list over " + std::to_string(balances.size()) + " addresses");
+        return richList->load(db.get(), readOptions);
+        
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Exception rebuilding rich list: " + std::string(e.what()));
+        return false;
+    }
+}
+
+std::vector<RichListEntry> Database::getRichList(size_t count, size_t offset) const {
+    return richList ? richList->top(count, offset) : std::vector<RichListEntry>();
+}
+
+bool Database::getRichListRank(const std::string& address, RichListEntry& entry) const {
+    return richList && richList->rank(address, entry);
+}
+
+std::vector<RichListBucket> Database::getBalanceDistribution(const std::vector<Amount>& thresholds) const {
+    return richList ? richList->histogram(thresholds) : std::vector<RichListBucket>();
+}
+
 double Database::getAddressBalance(const std::string& address) const {
     double balance = 0.0;
     auto utxos = getUTXOsByAddress(address);
@@ -814,22 +2314,53 @@ bool Database::isConnected() const {
 // Validator operations
 bool Database::storeValidator(const Validator& validator) {
     std::string data = serializeValidator(validator);
+    if (validatorMetrics) {
+        // A full record supersedes any deltas still waiting to be folded
+        return validatorMetrics->replace(validator.getAddress(), data);
+    }
     return put(makeKey(PREFIX_VALIDATOR, validator.getAddress()), data);
 }
 
 bool Database::getValidator(const std::string& address, Validator& validator) const {
     std::string data;
-    if (!get(makeKey(PREFIX_VALIDATOR, address), data)) return false;
+    ValidatorDelta pending;
+    if (validatorMetrics) {
+        if (!validatorMetrics->read(address, data, pending)) return false;
+    } else if (!get(makeKey(PREFIX_VALIDATOR, address), data)) {
+        return false;
+    }
     
-    validator = deserializeValidator(data);
+    validator = deserializeValidator(data, pending);
     return true;
 }
 
+// Per-block metric changes are appended as small delta records instead of
+// rewriting each validator's full record; see ValidatorMetricsLog
+bool Database::recordValidatorDeltas(const std::vector<std::pair<std::string, ValidatorDelta>>& deltas) {
+    if (!validatorMetrics) return false;
+    return validatorMetrics->append(deltas);
+}
+
+bool Database::recordValidatorDelta(const std::string& address, const ValidatorDelta& delta) {
+    return recordValidatorDeltas({{address, delta}});
+}
+
+bool Database::foldValidatorDeltas() {
+    return validatorMetrics && validatorMetrics->foldAll();
+}
+
+ValidatorMetricsLog::Stats Database::getValidatorMetricsStats() const {
+    return validatorMetrics ? validatorMetrics->getStats() : ValidatorMetricsLog::Stats();
+}
+
 bool Database::updateValidator(const Validator& validator) {
     return storeValidator(validator);
 }
 
 bool Database::deleteValidator(const std::string& address) {
+    if (validatorMetrics) {
+        return validatorMetrics->remove(address);
+    }
     return del(makeKey(PREFIX_VALIDATOR, address));
 }
 
@@ -844,7 +2375,13 @@ std::vector<Validator> Database::getAllValidators() const {
         std::string key = it->key().ToString();
         if (key.find(PREFIX_VALIDATOR) != 0) break;
         
-        validators.push_back(deserializeValidator(it->value().ToString()));
+        // Re-read through the log so a concurrent fold is never half applied
+        std::string data = it->value().ToString();
+        ValidatorDelta pending;
+        if (validatorMetrics && !validatorMetrics->read(key.substr(PREFIX_VALIDATOR.size()), data, pending)) {
+            continue;
+        }
+        validators.push_back(deserializeValidator(data, pending));
     }
     
     return validators;
@@ -949,14 +2486,31 @@ double Database::getTotalBurned() const {
 
 // Maintenance
 bool Database::vacuum() {
-    // LevelDB handles compaction automatically
-    if (db) {
-        db->CompactRange(nullptr, nullptr);
+    // Compact the whole keyspace range by range in the background instead of
+    // blocking the caller on CompactRange(nullptr, nullptr)
+    if (db && compactionScheduler) {
+        compactionScheduler->requestFullPass();
         return true;
     }
     return false;
 }
 
+void Database::pauseBackgroundCompaction() {
+    if (compactionScheduler) {
+        compactionScheduler->pause();
+    }
+}
+
+void Database::resumeBackgroundCompaction() {
+    if (compactionScheduler) {
+        compactionScheduler->resume();
+    }
+}
+
+CompactionScheduler::Stats Database::getCompactionStats() const {
+    return compactionScheduler ? compactionScheduler->getStats() : CompactionScheduler::Stats();
+}
+
 bool Database::backup(const std::string& backupPath) {
     // Simple backup by copying database directory
     try {
@@ -981,6 +2535,351 @@ bool Database::restore(const std::string& backupPath) {
     }
 }
 
+// UTXO snapshots
+// A snapshot is a directory holding manifest.json plus Snappy-compressed chunks of the
+// sorted utxo: keyspace. Each chunk is hashed uncompressed and the manifest commits to
+// the height, block hash, UTXO set hash and every chunk hash, so a single commitment
+// authenticates it.
+bool Database::exportUtxoSnapshot(const std::string& snapshotDir, uint32_t height) const {
+    if (!db) return false;
+    
+    const leveldb::Snapshot* dbSnapshot = db->GetSnapshot();
+    leveldb::ReadOptions snapOptions = readOptions;
+    snapOptions.snapshot = dbSnapshot;
+    snapOptions.fill_cache = false;
+    
+    try {
+        // The UTXO set only exists at the tip, so the requested height must be the tip
+        std::string tipHeight, tipHash;
+        db->Get(snapOptions, makeKey(PREFIX_CONFIG, "latest_block_height"), &tipHeight);
+        db->Get(snapOptions, makeKey(PREFIX_CONFIG, "latest_block_hash"), &tipHash);
+        if (tipHeight.empty() || std::stoul(tipHeight) != height) {
+            LOG_DATABASE(LogLevel::ERROR, "UTXO snapshot height " + std::to_string(height) +
+                        " is not the current tip (" + (tipHeight.empty() ? "none" : tipHeight) + ")");
+            db->ReleaseSnapshot(dbSnapshot);
+            return false;
+        }
+        
+        std::filesystem::create_directories(snapshotDir);
+        
+        json chunks = json::array();
+        uint64_t entryCount = 0;
+        UtxoSetHash setHash;
+        std::string payload;
+        std::string compressed;
+        std::string firstKey, lastKey;
+        size_t chunkEntries = 0;
+        
+        auto flushChunk = [&]() {
+            std::string name = snapshotChunkName(chunks.size());
+            snappy::Compress(payload.data(), payload.size(), &compressed);
+            
+            std::ofstream file(std::filesystem::path(snapshotDir) / name, std::ios::binary | std::ios::trunc);
+            file.write(compressed.data(), compressed.size());
+            if (!file) {
+                throw std::runtime_error("failed to write " + name);
+            }
+            
+            json chunk;
+            chunk["file"] = name;
+            chunk["entries"] = chunkEntries;
+            chunk["hash"] = keccak256(payload);
+            chunk["first_key"] = firstKey;
+            chunk["last_key"] = lastKey;
+            chunks.push_back(chunk);
+            
+            payload.clear();
+            chunkEntries = 0;
+        };
+        
+        std::unique_ptr<leveldb::Iterator> it(db->NewIterator(snapOptions));
+        for (it->Seek(PREFIX_UTXO); it->Valid(); it->Next()) {
+            leveldb::Slice key = it->key();
+            if (!key.starts_with(PREFIX_UTXO)) break;
+            
+            if (chunkEntries == 0) {
+                firstKey = key.ToString();
+            }
+            lastKey = key.ToString();
+            setHash.add(lastKey, it->value().ToString());
+            appendLengthPrefixed(payload, key);
+            appendLengthPrefixed(payload, it->value());
+            chunkEntries++;
+            entryCount++;
+            
+            if (chunkEntries == UTXO_SNAPSHOT_CHUNK_ENTRIES) {
+                flushChunk();
+            }
+        }
+        if (chunkEntries > 0) {
+            flushChunk();
+        }
+        
+        json manifest;
+        manifest["version"] = UTXO_SNAPSHOT_VERSION;
+        manifest["network"] = Config::isTestnet() ? "testnet" : "mainnet";
+        manifest["height"] = height;
+        manifest["block_hash"] = tipHash;
+        manifest["entry_count"] = entryCount;
+        manifest["utxo_set_hash"] = setHash.digest();
+        manifest["chunks"] = chunks;
+        manifest["commitment"] = snapshotCommitment(height, tipHash, manifest["utxo_set_hash"], chunks);
+        
+        std::ofstream manifestFile(std::filesystem::path(snapshotDir) / "manifest.json", std::ios::trunc);
+        manifestFile << manifest.dump(2);
+        if (!manifestFile) {
+            throw std::runtime_error("failed to write manifest.json");
+        }
+        
+        db->ReleaseSnapshot(dbSnapshot);
+        LOG_DATABASE(LogLevel::INFO, "Exported UTXO snapshot at height " + std::to_string(height) + ": " +
+                    std::to_string(entryCount) + " entries in " + std::to_string(chunks.size()) + " chunks");
+        return true;
+        
+    } catch (const std::exception& e) {
+        db->ReleaseSnapshot(dbSnapshot);
+        LOG_DATABASE(LogLevel::ERROR, "Exception exporting UTXO snapshot: " + std::string(e.what()));
+        return false;
+    }
+}
+
+bool Database::importUtxoSnapshot(const std::string& snapshotDir, const std::string& expectedCommitment) {
+    if (!db) return false;
+    
+    std::lock_guard<std::mutex> utxoLock(utxoSetMutex);
+    CompactionPause compactionPause(compactionScheduler.get());
+    
+    // Snapshots bootstrap a fresh node; never merge one into existing chain state
+    std::string existing;
+    if (getConfigValue("latest_block_height", existing)) {
+        LOG_DATABASE(LogLevel::ERROR, "Refusing to import UTXO snapshot into a database that already has blocks");
+        return false;
+    }
+    
+    json manifest;
+    try {
+        std::ifstream manifestFile(std::filesystem::path(snapshotDir) / "manifest.json");
+        manifest = json::parse(manifestFile);
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Failed to read UTXO snapshot manifest: " + std::string(e.what()));
+        return false;
+    }
+    
+    try {
+        uint32_t height = manifest["height"].get<uint32_t>();
+        std::string blockHash = manifest["block_hash"].get<std::string>();
+        const json& chunks = manifest["chunks"];
+        
+        if (manifest["version"].get<uint32_t>() != UTXO_SNAPSHOT_VERSION) {
+            LOG_DATABASE(LogLevel::ERROR, "Unsupported UTXO snapshot version");
+            return false;
+        }
+        if (manifest["network"].get<std::string>() != (Config::isTestnet() ? "testnet" : "mainnet")) {
+            LOG_DATABASE(LogLevel::ERROR, "UTXO snapshot belongs to a different network");
+            return false;
+        }
+        
+        std::string expectedSetHash = manifest["utxo_set_hash"].get<std::string>();
+        std::string commitment = snapshotCommitment(height, blockHash, expectedSetHash, chunks);
+        if (commitment != manifest["commitment"].get<std::string>() ||
+            (!expectedCommitment.empty() && commitment != expectedCommitment)) {
+            LOG_DATABASE(LogLevel::ERROR, "UTXO snapshot commitment mismatch");
+            return false;
+        }
+        
+        // Chunk files are named by position; anything else could reach outside snapshotDir.
+        // Chunk key ranges must be strictly increasing so chunks cannot overlap or repeat
+        for (size_t i = 0; i < chunks.size(); i++) {
+            if (chunks[i]["file"].get<std::string>() != snapshotChunkName(i)) {
+                LOG_DATABASE(LogLevel::ERROR, "UTXO snapshot chunk " + std::to_string(i) + " has an invalid file name");
+                return false;
+            }
+            const std::string first = chunks[i]["first_key"].get<std::string>();
+            const std::string last = chunks[i]["last_key"].get<std::string>();
+            if (first > last || (i > 0 && first <= chunks[i - 1]["last_key"].get<std::string>())) {
+                LOG_DATABASE(LogLevel::ERROR, "UTXO snapshot chunks are not sorted");
+                return false;
+            }
+        }
+        
+        // Verify and load chunks in parallel; each worker claims the next chunk index
+        std::atomic<size_t> nextChunk{0};
+        std::atomic<bool> failed{false};
+        std::atomic<uint64_t> loadedEntries{0};
+        
+        // Each worker hashes its own chunks; LtHash states add up to the hash of the whole set
+        std::mutex setHashMutex;
+        UtxoSetHash setHash;
+        Amount totalAmount = 0;
+        std::unordered_map<std::string, Amount> balances;
+        
+        auto worker = [&]() {
+            UtxoSetHash localHash;
+            Amount localAmount = 0;
+            std::unordered_map<std::string, Amount> localBalances;
+            std::string compressed, payload, key, value;
+            while (!failed) {
+                size_t index = nextChunk++;
+                if (index >= chunks.size()) break;
+                const json& chunk = chunks[index];
+                
+                std::ifstream file(std::filesystem::path(snapshotDir) / snapshotChunkName(index), std::ios::binary);
+                if (!file) {
+                    LOG_DATABASE(LogLevel::ERROR, "UTXO snapshot chunk " + std::to_string(index) + " is missing");
+                    failed = true;
+                    break;
+                }
+                compressed.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                if (!snappy::Uncompress(compressed.data(), compressed.size(), &payload) ||
+                    keccak256(payload) != chunk["hash"].get<std::string>()) {
+                    LOG_DATABASE(LogLevel::ERROR, "UTXO snapshot chunk " + std::to_string(index) + " failed verification");
+                    failed = true;
+                    break;
+                }
+                
+                const std::string first = chunk["first_key"].get<std::string>();
+                const std::string last = chunk["last_key"].get<std::string>();
+                leveldb::WriteBatch batch;
+                std::string prevKey;
+                size_t pos = 0;
+                uint64_t entries = 0;
+                
+                while (pos < payload.size()) {
+                    if (!readLengthPrefixed(payload, pos, key) || !readLengthPrefixed(payload, pos, value) ||
+                        key.compare(0, PREFIX_UTXO.size(), PREFIX_UTXO) != 0 ||
+                        (entries == 0 ? key != first : key <= prevKey) || key > last) {
+                        failed = true;
+                        break;
+                    }
+                    
+                    json utxo = json::parse(value);
+                    const std::string& address = utxo["address"].get_ref<const std::string&>();
+                    std::string outpoint = key.substr(PREFIX_UTXO.size());
+                    batch.Put(key, value);
+                    batch.Put(makeKey(PREFIX_ADDRESS, address + ":" + outpoint), value);
+                    localHash.add(key, value);
+                    Amount amount = 0;
+                    toAmount(utxo["amount"].get<double>(), amount);
+                    localAmount += amount;
+                    localBalances[address] += amount;
+                    
+                    prevKey.swap(key);
+                    entries++;
+                }
+                
+                if (failed || prevKey != last || entries != chunk["entries"].get<uint64_t>()) {
+                    LOG_DATABASE(LogLevel::ERROR, "UTXO snapshot chunk " + std::to_string(index) + " is malformed");
+                    failed = true;
+                    break;
+                }
+                
+                if (!db->Write(writeOptions, &batch).ok()) {
+                    failed = true;
+                    break;
+                }
+                loadedEntries += entries;
+            }
+            
+            std::lock_guard<std::mutex> lock(setHashMutex);
+            setHash.combine(localHash);
+            totalAmount += localAmount;
+            for (const auto& entry : localBalances) {
+                balances[entry.first] += entry.second;
+            }
+        };
+        
+        size_t threadCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), chunks.size()));
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < threadCount; i++) {
+            workers.emplace_back([&]() {
+                try {
+                    worker();
+                } catch (const std::exception& e) {
+                    LOG_DATABASE(LogLevel::ERROR, "Exception loading UTXO snapshot chunk: " + std::string(e.what()));
+                    failed = true;
+                }
+            });
+        }
+        for (auto& t : workers) {
+            t.join();
+        }
+        
+        if (!failed && setHash.digest() != expectedSetHash) {
+            LOG_DATABASE(LogLevel::ERROR, "UTXO snapshot set hash mismatch");
+            failed = true;
+        }
+        
+        if (failed || loadedEntries != manifest["entry_count"].get<uint64_t>()) {
+            LOG_DATABASE(LogLevel::ERROR, "UTXO snapshot import failed, removing partially loaded state");
+            leveldb::WriteBatch cleanup;
+            std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
+            for (const auto& prefix : {PREFIX_UTXO, PREFIX_ADDRESS}) {
+                for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
+                    cleanup.Delete(it->key());
+                }
+            }
+            db->Write(writeOptions, &cleanup);
+            return false;
+        }
+        
+        UtxoSetInfo info;
+        info.height = height;
+        info.hash = expectedSetHash;
+        info.txoutCount = loadedEntries;
+        info.totalAmount = totalAmount;
+        
+        // Serve from the snapshot tip; history below it still has to be validated in the background
+        leveldb::WriteBatch batch;
+        batch.Put(makeKey(PREFIX_CONFIG, "utxo_set_state"), utxoSetStateRecord(setHash, info));
+        batch.Put(makeKey(PREFIX_UTXO_STATS, height), utxoSetInfoToJson(info));
+        batch.Put(makeKey(PREFIX_CONFIG, "latest_block_height"), std::to_string(height));
+        batch.Put(makeKey(PREFIX_CONFIG, "latest_block_hash"), blockHash);
+        batch.Put(makeKey(PREFIX_CONFIG, "snapshot_base_height"), std::to_string(height));
+        batch.Put(makeKey(PREFIX_CONFIG, "snapshot_base_hash"), blockHash);
+        batch.Put(makeKey(PREFIX_CONFIG, "snapshot_commitment"), commitment);
+        batch.Put(makeKey(PREFIX_CONFIG, "snapshot_history_validated"), "0");
+        
+        // Running balances start at the base: one bal: entry per address holding its
+        // whole snapshot balance, so getAddressBalanceAt() answers from the base up
+        json seededAddresses = json::array();
+        for (const auto& entry : balances) {
+            batch.Put(balanceKey(PREFIX_BALANCE, entry.first, height), balanceEntryToJson(entry.second, entry.second));
+            seededAddresses.push_back(entry.first);
+        }
+        if (!balances.empty()) {
+            batch.Put(makeKey(PREFIX_BALANCE_BLOCK, height), seededAddresses.dump());
+        }
+        if (!db->Write(writeOptions, &batch).ok()) {
+            return false;
+        }
+        
+        LOG_DATABASE(LogLevel::INFO, "Imported UTXO snapshot at height " + std::to_string(height) + ": " +
+                    std::to_string(loadedEntries.load()) + " entries from " + std::to_string(chunks.size()) + " chunks");
+        
+        // Balances came from the snapshot, not from blocks
+        rebuildRichList();
+        return true;
+        
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Exception importing UTXO snapshot: " + std::string(e.what()));
+        return false;
+    }
+}
+
+bool Database::getSnapshotBase(uint32_t& height, std::string& blockHash) const {
+    std::string value;
+    if (!getConfigValue("snapshot_base_height", value)) {
+        return false;
+    }
+    height = std::stoul(value);
+    getConfigValue("snapshot_base_hash", blockHash);
+    return true;
+}
+
+bool Database::markSnapshotHistoryValidated() {
+    return setConfigValue("snapshot_history_validated", "1");
+}
+
 uint64_t Database::getDatabaseSize() const {
     uint64_t size = 0;
     try {
@@ -0,0 +1,329 @@
+#include "../include/KeccakBatch.h"
+#include "../include/KeccakHasher.h"
+#include "../include/Utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <numeric>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define GXC_KECCAK_X86_SIMD 1
+typedef uint64_t KeccakLanes4 __attribute__((vector_size(32)));
+typedef uint64_t KeccakLanes8 __attribute__((vector_size(64)));
+#endif
+
+static const size_t RATE = KeccakHasher::RATE;
+static const size_t RATE_WORDS = KeccakHasher::RATE / 8;
+
+static inline uint64_t loadWord(const uint8_t* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+#else
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+#endif
+}
+
+#ifdef GXC_KECCAK_X86_SIMD
+
+// Keccak-f[1600] on N interleaved states: a[i] holds word i of every lane. Written
+// with GCC vector extensions so the same body compiles to AVX2 or AVX-512 code
+// depending on the target of the function it is inlined into.
+// A macro rather than a function: vector arguments passed by value outside the
+// target-specific callers would change the calling convention
+#define GXC_ROTL_LANES(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+template <typename V>
+static inline __attribute__((always_inline)) void permuteLanes(V* a) {
+    for (int round = 0; round < 24; round++) {
+        V c0 = a[0] ^ a[5] ^ a[10] ^ a[15] ^ a[20];
+        V c1 = a[1] ^ a[6] ^ a[11] ^ a[16] ^ a[21];
+        V c2 = a[2] ^ a[7] ^ a[12] ^ a[17] ^ a[22];
+        V c3 = a[3] ^ a[8] ^ a[13] ^ a[18] ^ a[23];
+        V c4 = a[4] ^ a[9] ^ a[14] ^ a[19] ^ a[24];
+        
+        V d0 = c4 ^ GXC_ROTL_LANES(c1, 1);
+        V d1 = c0 ^ GXC_ROTL_LANES(c2, 1);
+        V d2 = c1 ^ GXC_ROTL_LANES(c3, 1);
+        V d3 = c2 ^ GXC_ROTL_LANES(c4, 1);
+        V d4 = c3 ^ GXC_ROTL_LANES(c0, 1);
+        
+        // Same lane mapping as KeccakHasher::permute
+        V b[25];
+        b[0]  = a[0] ^ d0;
+        b[10] = GXC_ROTL_LANES(a[1] ^ d1, 1);
+        b[20] = GXC_ROTL_LANES(a[2] ^ d2, 62);
+        b[5]  = GXC_ROTL_LANES(a[3] ^ d3, 28);
+        b[15] = GXC_ROTL_LANES(a[4] ^ d4, 27);
+        b[16] = GXC_ROTL_LANES(a[5] ^ d0, 36);
+        b[1]  = GXC_ROTL_LANES(a[6] ^ d1, 44);
+        b[11] = GXC_ROTL_LANES(a[7] ^ d2, 6);
+        b[21] = GXC_ROTL_LANES(a[8] ^ d3, 55);
+        b[6]  = GXC_ROTL_LANES(a[9] ^ d4, 20);
+        b[7]  = GXC_ROTL_LANES(a[10] ^ d0, 3);
+        b[17] = GXC_ROTL_LANES(a[11] ^ d1, 10);
+        b[2]  = GXC_ROTL_LANES(a[12] ^ d2, 43);
+        b[12] = GXC_ROTL_LANES(a[13] ^ d3, 25);
+        b[22] = GXC_ROTL_LANES(a[14] ^ d4, 39);
+        b[23] = GXC_ROTL_LANES(a[15] ^ d0, 41);
+        b[8]  = GXC_ROTL_LANES(a[16] ^ d1, 45);
+        b[18] = GXC_ROTL_LANES(a[17] ^ d2, 15);
+        b[3]  = GXC_ROTL_LANES(a[18] ^ d3, 21);
+        b[13] = GXC_ROTL_LANES(a[19] ^ d4, 8);
+        b[14] = GXC_ROTL_LANES(a[20] ^ d0, 18);
+        b[24] = GXC_ROTL_LANES(a[21] ^ d1, 2);
+        b[9]  = GXC_ROTL_LANES(a[22] ^ d2, 61);
+        b[19] = GXC_ROTL_LANES(a[23] ^ d3, 56);
+        b[4]  = GXC_ROTL_LANES(a[24] ^ d4, 14);
+        
+        for (int y = 0; y < 25; y += 5) {
+            a[y + 0] = b[y + 0] ^ (~b[y + 1] & b[y + 2]);
+            a[y + 1] = b[y + 1] ^ (~b[y + 2] & b[y + 3]);
+            a[y + 2] = b[y + 2] ^ (~b[y + 3] & b[y + 4]);
+            a[y + 3] = b[y + 3] ^ (~b[y + 4] & b[y + 0]);
+            a[y + 4] = b[y + 4] ^ (~b[y + 0] & b[y + 1]);
+        }
+        
+        a[0] ^= KeccakHasher::ROUND_CONSTANTS[round];
+    }
+}
+
+// Hashes up to N messages, one per lane. Lanes run in lock step for as many blocks
+// as the longest message needs; a lane's digest is read right after its own final
+// block, so the extra permutations it sits through afterwards do not matter.
+template <typename V, size_t N>
+static inline __attribute__((always_inline)) void hashLanes(const std::string_view* messages, size_t count,
+                                                            Hash256* digests, uint8_t padding) {
+    uint8_t tails[N][RATE];
+    size_t blocks[N];
+    size_t maxBlocks = 0;
+    
+    for (size_t lane = 0; lane < N; lane++) {
+        if (lane >= count) {
+            blocks[lane] = 0;
+            continue;
+        }
+        size_t length = messages[lane].size();
+        size_t full = length / RATE;
+        size_t remainder = length - full * RATE;
+        std::memset(tails[lane], 0, RATE);
+        std::memcpy(tails[lane], messages[lane].data() + full * RATE, remainder);
+        tails[lane][remainder] ^= padding;
+        tails[lane][RATE - 1] ^= 0x80;
+        blocks[lane] = full + 1;
+        maxBlocks = std::max(maxBlocks, blocks[lane]);
+    }
+    
+    V state[25];
+    std::memset(state, 0, sizeof(state));
+    
+    for (size_t block = 0; block < maxBlocks; block++) {
+        const uint8_t* input[N];
+        for (size_t lane = 0; lane < N; lane++) {
+            if (block + 1 < blocks[lane]) {
+                input[lane] = reinterpret_cast<const uint8_t*>(messages[lane].data()) + block * RATE;
+            } else if (block + 1 == blocks[lane]) {
+                input[lane] = tails[lane];
+            } else {
+                input[lane] = nullptr;
+            }
+        }
+        
+        for (size_t word = 0; word < RATE_WORDS; word++) {
+            V lanes;
+            for (size_t lane = 0; lane < N; lane++) {
+                lanes[lane] = input[lane] ? loadWord(input[lane] + 8 * word) : 0;
+            }
+            state[word] ^= lanes;
+        }
+        
+        permuteLanes(state);
+        
+        for (size_t lane = 0; lane < N; lane++) {
+            if (block + 1 != blocks[lane]) continue;
+            for (size_t i = 0; i < Hash256::SIZE; i++) {
+                digests[lane].bytes[i] = static_cast<uint8_t>(state[i / 8][lane] >> (8 * (i % 8)));
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void hashLanesAvx2(const std::string_view* messages, size_t count, Hash256* digests, uint8_t padding) {
+    hashLanes<KeccakLanes4, 4>(messages, count, digests, padding);
+}
+
+__attribute__((target("avx512f")))
+static void hashLanesAvx512(const std::string_view* messages, size_t count, Hash256* digests, uint8_t padding) {
+    hashLanes<KeccakLanes8, 8>(messages, count, digests, padding);
+}
+
+#endif // GXC_KECCAK_X86_SIMD
+
+static void hashScalar(const std::string_view& message, Hash256& digest) {
+    KeccakHasher hasher;
+    hasher.update(message.data(), message.size());
+    hasher.finalize(digest.bytes.data());
+}
+
+static size_t laneCount(KeccakBatch::Implementation impl) {
+    switch (impl) {
+        case KeccakBatch::Implementation::AVX512: return 8;
+        case KeccakBatch::Implementation::AVX2: return 4;
+        default: return 1;
+    }
+}
+
+static void hashGroup(KeccakBatch::Implementation impl, const std::string_view* messages, size_t count,
+                      Hash256* digests) {
+#ifdef GXC_KECCAK_X86_SIMD
+    uint8_t padding = KeccakHasher::padding();
+    if (impl == KeccakBatch::Implementation::AVX512) {
+        hashLanesAvx512(messages, count, digests, padding);
+        return;
+    }
+    if (impl == KeccakBatch::Implementation::AVX2) {
+        hashLanesAvx2(messages, count, digests, padding);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; i++) {
+        hashScalar(messages[i], digests[i]);
+    }
+}
+
+static bool cpuSupports(KeccakBatch::Implementation impl) {
+#ifdef GXC_KECCAK_X86_SIMD
+    if (impl == KeccakBatch::Implementation::AVX512) return __builtin_cpu_supports("avx512f");
+    if (impl == KeccakBatch::Implementation::AVX2) return __builtin_cpu_supports("avx2");
+#endif
+    return impl == KeccakBatch::Implementation::SCALAR;
+}
+
+// Lengths straddle the rate boundary and lanes finish on different blocks
+static bool selfTest(KeccakBatch::Implementation impl) {
+    static const size_t lengths[] = {0, 1, 55, 135, 136, 137, 200, 271, 272, 273, 500, 1000};
+    std::vector<std::string> messages;
+    for (size_t length : lengths) {
+        std::string message(length, '\0');
+        for (size_t i = 0; i < length; i++) {
+            message[i] = static_cast<char>((i * 131 + length * 7) & 0xff);
+        }
+        messages.push_back(std::move(message));
+    }
+    
+    std::vector<std::string_view> views(messages.begin(), messages.end());
+    std::vector<Hash256> digests(views.size());
+    size_t lanes = laneCount(impl);
+    for (size_t i = 0; i < views.size(); i += lanes) {
+        hashGroup(impl, views.data() + i, std::min(lanes, views.size() - i), digests.data() + i);
+    }
+    
+    for (size_t i = 0; i < views.size(); i++) {
+        Hash256 expected;
+        hashScalar(views[i], expected);
+        if (digests[i] != expected) return false;
+    }
+    return true;
+}
+
+static bool usable(KeccakBatch::Implementation impl) {
+    // SIMD lanes only implement the padded-sponge path, not the buffered fallback
+    if (impl != KeccakBatch::Implementation::SCALAR && KeccakHasher::padding() == 0) return false;
+    return cpuSupports(impl) && selfTest(impl);
+}
+
+static std::atomic<KeccakBatch::Implementation>& selected() {
+    static std::atomic<KeccakBatch::Implementation> impl([] {
+        for (auto candidate : {KeccakBatch::Implementation::AVX512, KeccakBatch::Implementation::AVX2}) {
+            if (usable(candidate)) return candidate;
+        }
+        return KeccakBatch::Implementation::SCALAR;
+    }());
+    return impl;
+}
+
+void KeccakBatch::hash(const std::string_view* messages, size_t count, Hash256* digests) {
+    Implementation impl = implementation();
+    size_t lanes = laneCount(impl);
+    if (lanes == 1 || count < 2) {
+        for (size_t i = 0; i < count; i++) {
+            hashScalar(messages[i], digests[i]);
+        }
+        return;
+    }
+    
+    // Group messages of similar length so lanes finish together
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [messages](size_t a, size_t b) {
+        return messages[a].size() / RATE < messages[b].size() / RATE;
+    });
+    
+    std::string_view group[8];
+    Hash256 groupDigests[8];
+    for (size_t start = 0; start < count; start += lanes) {
+        size_t groupSize = std::min(lanes, count - start);
+        
+        // A mostly empty group is slower than hashing its few messages one by one
+        if (groupSize * 2 < lanes) {
+            for (size_t i = 0; i < groupSize; i++) {
+                hashScalar(messages[order[start + i]], digests[order[start + i]]);
+            }
+            break;
+        }
+        
+        for (size_t i = 0; i < groupSize; i++) {
+            group[i] = messages[order[start + i]];
+        }
+        hashGroup(impl, group, groupSize, groupDigests);
+        for (size_t i = 0; i < groupSize; i++) {
+            digests[order[start + i]] = groupDigests[i];
+        }
+    }
+}
+
+std::vector<Hash256> KeccakBatch::hash(const std::vector<std::string_view>& messages) {
+    std::vector<Hash256> digests(messages.size());
+    hash(messages.data(), messages.size(), digests.data());
+    return digests;
+}
+
+std::vector<std::string> KeccakBatch::hashHex(const std::vector<std::string>& messages) {
+    std::vector<std::string_view> views(messages.begin(), messages.end());
+    std::vector<Hash256> digests = hash(views);
+    
+    std::vector<std::string> hex;
+    hex.reserve(digests.size());
+    for (const auto& digest : digests) {
+        hex.push_back(Utils::toHex(std::vector<uint8_t>(digest.bytes.begin(), digest.bytes.end())));
+    }
+    return hex;
+}
+
+KeccakBatch::Implementation KeccakBatch::implementation() {
+    return selected().load(std::memory_order_relaxed);
+}
+
+const char* KeccakBatch::implementationName() {
+    switch (implementation()) {
+        case Implementation::AVX512: return "avx512";
+        case Implementation::AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+size_t KeccakBatch::lanes() {
+    return laneCount(implementation());
+}
+
+void KeccakBatch::setImplementation(Implementation impl) {
+    if (usable(impl)) {
+        selected().store(impl, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,210 @@
+#include "../include/KeccakHasher.h"
+#include "../include/HashUtils.h"
+#include "../include/Utils.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+const uint64_t KeccakHasher::ROUND_CONSTANTS[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+static inline uint64_t rotl64(uint64_t x, unsigned n) {
+    return (x << n) | (x >> (64 - n));
+}
+
+static inline uint64_t loadLE64(const uint8_t* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+#else
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+#endif
+}
+
+// Padding byte of the reference keccak256(), or 0 if this implementation cannot match it
+static uint8_t detectPadding() {
+    static const uint8_t padding = []() -> uint8_t {
+        const std::string probe = "GXC keccak self-test";
+        std::string expected = keccak256(probe);
+        for (uint8_t candidate : {uint8_t(0x01), uint8_t(0x06)}) {
+            uint64_t state[25] = {0};
+            uint8_t block[KeccakHasher::RATE] = {0};
+            std::memcpy(block, probe.data(), probe.size());
+            block[probe.size()] ^= candidate;
+            block[KeccakHasher::RATE - 1] ^= 0x80;
+            for (size_t i = 0; i < KeccakHasher::RATE / 8; i++) {
+                state[i] ^= loadLE64(block + 8 * i);
+            }
+            KeccakHasher::permute(state);
+            
+            std::vector<uint8_t> digest(KeccakHasher::DIGEST_SIZE);
+            for (size_t i = 0; i < KeccakHasher::DIGEST_SIZE; i++) {
+                digest[i] = static_cast<uint8_t>(state[i / 8] >> (8 * (i % 8)));
+            }
+            if (Utils::fromHex(expected) == digest) {
+                return candidate;
+            }
+        }
+        return 0;
+    }();
+    return padding;
+}
+
+void KeccakHasher::permute(uint64_t state[25]) {
+    // The 25 lanes live in locals for all 24 rounds so the compiler can keep them in
+    // registers; the lane permutation is applied through the b* names
+    uint64_t a00 = state[0],  a01 = state[1],  a02 = state[2],  a03 = state[3],  a04 = state[4];
+    uint64_t a05 = state[5],  a06 = state[6],  a07 = state[7],  a08 = state[8],  a09 = state[9];
+    uint64_t a10 = state[10], a11 = state[11], a12 = state[12], a13 = state[13], a14 = state[14];
+    uint64_t a15 = state[15], a16 = state[16], a17 = state[17], a18 = state[18], a19 = state[19];
+    uint64_t a20 = state[20], a21 = state[21], a22 = state[22], a23 = state[23], a24 = state[24];
+    
+    for (int round = 0; round < 24; round++) {
+        uint64_t c0 = a00 ^ a05 ^ a10 ^ a15 ^ a20;
+        uint64_t c1 = a01 ^ a06 ^ a11 ^ a16 ^ a21;
+        uint64_t c2 = a02 ^ a07 ^ a12 ^ a17 ^ a22;
+        uint64_t c3 = a03 ^ a08 ^ a13 ^ a18 ^ a23;
+        uint64_t c4 = a04 ^ a09 ^ a14 ^ a19 ^ a24;
+        
+        uint64_t d0 = c4 ^ rotl64(c1, 1);
+        uint64_t d1 = c0 ^ rotl64(c2, 1);
+        uint64_t d2 = c1 ^ rotl64(c3, 1);
+        uint64_t d3 = c2 ^ rotl64(c4, 1);
+        uint64_t d4 = c3 ^ rotl64(c0, 1);
+        
+        // Theta, rho and pi: b[y][2x+3y] = rotl(a[x][y] ^ d[x], r[x][y])
+        uint64_t b00 = a00 ^ d0;
+        uint64_t b10 = rotl64(a01 ^ d1, 1);
+        uint64_t b20 = rotl64(a02 ^ d2, 62);
+        uint64_t b05 = rotl64(a03 ^ d3, 28);
+        uint64_t b15 = rotl64(a04 ^ d4, 27);
+        uint64_t b16 = rotl64(a05 ^ d0, 36);
+        uint64_t b01 = rotl64(a06 ^ d1, 44);
+        uint64_t b11 = rotl64(a07 ^ d2, 6);
+        uint64_t b21 = rotl64(a08 ^ d3, 55);
+        uint64_t b06 = rotl64(a09 ^ d4, 20);
+        uint64_t b07 = rotl64(a10 ^ d0, 3);
+        uint64_t b17 = rotl64(a11 ^ d1, 10);
+        uint64_t b02 = rotl64(a12 ^ d2, 43);
+        uint64_t b12 = rotl64(a13 ^ d3, 25);
+        uint64_t b22 = rotl64(a14 ^ d4, 39);
+        uint64_t b23 = rotl64(a15 ^ d0, 41);
+        uint64_t b08 = rotl64(a16 ^ d1, 45);
+        uint64_t b18 = rotl64(a17 ^ d2, 15);
+        uint64_t b03 = rotl64(a18 ^ d3, 21);
+        uint64_t b13 = rotl64(a19 ^ d4, 8);
+        uint64_t b14 = rotl64(a20 ^ d0, 18);
+        uint64_t b24 = rotl64(a21 ^ d1, 2);
+        uint64_t b09 = rotl64(a22 ^ d2, 61);
+        uint64_t b19 = rotl64(a23 ^ d3, 56);
+        uint64_t b04 = rotl64(a24 ^ d4, 14);
+        
+        // Chi
+        a00 = b00 ^ (~b01 & b02); a01 = b01 ^ (~b02 & b03); a02 = b02 ^ (~b03 & b04);
+        a03 = b03 ^ (~b04 & b00); a04 = b04 ^ (~b00 & b01);
+        a05 = b05 ^ (~b06 & b07); a06 = b06 ^ (~b07 & b08); a07 = b07 ^ (~b08 & b09);
+        a08 = b08 ^ (~b09 & b05); a09 = b09 ^ (~b05 & b06);
+        a10 = b10 ^ (~b11 & b12); a11 = b11 ^ (~b12 & b13); a12 = b12 ^ (~b13 & b14);
+        a13 = b13 ^ (~b14 & b10); a14 = b14 ^ (~b10 & b11);
+        a15 = b15 ^ (~b16 & b17); a16 = b16 ^ (~b17 & b18); a17 = b17 ^ (~b18 & b19);
+        a18 = b18 ^ (~b19 & b15); a19 = b19 ^ (~b15 & b16);
+        a20 = b20 ^ (~b21 & b22); a21 = b21 ^ (~b22 & b23); a22 = b22 ^ (~b23 & b24);
+        a23 = b23 ^ (~b24 & b20); a24 = b24 ^ (~b20 & b21);
+        
+        // Iota
+        a00 ^= ROUND_CONSTANTS[round];
+    }
+    
+    state[0]  = a00; state[1]  = a01; state[2]  = a02; state[3]  = a03; state[4]  = a04;
+    state[5]  = a05; state[6]  = a06; state[7]  = a07; state[8]  = a08; state[9]  = a09;
+    state[10] = a10; state[11] = a11; state[12] = a12; state[13] = a13; state[14] = a14;
+    state[15] = a15; state[16] = a16; state[17] = a17; state[18] = a18; state[19] = a19;
+    state[20] = a20; state[21] = a21; state[22] = a22; state[23] = a23; state[24] = a24;
+}
+
+uint8_t KeccakHasher::padding() {
+    return detectPadding();
+}
+
+KeccakHasher::KeccakHasher() {
+    reset();
+}
+
+void KeccakHasher::reset() {
+    std::memset(state, 0, sizeof(state));
+    bufferLength = 0;
+    fallback.clear();
+}
+
+void KeccakHasher::absorbBlock(const uint8_t* block) {
+    for (size_t i = 0; i < RATE / 8; i++) {
+        state[i] ^= loadLE64(block + 8 * i);
+    }
+    permute(state);
+}
+
+void KeccakHasher::update(const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    
+    if (detectPadding() == 0) {
+        fallback.append(reinterpret_cast<const char*>(bytes), length);
+        return;
+    }
+    
+    if (bufferLength > 0) {
+        size_t take = std::min(length, RATE - bufferLength);
+        std::memcpy(buffer + bufferLength, bytes, take);
+        bufferLength += take;
+        bytes += take;
+        length -= take;
+        if (bufferLength < RATE) return;
+        absorbBlock(buffer);
+        bufferLength = 0;
+    }
+    
+    while (length >= RATE) {
+        absorbBlock(bytes);
+        bytes += RATE;
+        length -= RATE;
+    }
+    
+    std::memcpy(buffer, bytes, length);
+    bufferLength = length;
+}
+
+void KeccakHasher::finalize(uint8_t digest[DIGEST_SIZE]) {
+    uint8_t padding = detectPadding();
+    if (padding == 0) {
+        std::vector<uint8_t> bytes = Utils::fromHex(keccak256(fallback));
+        std::memcpy(digest, bytes.data(), std::min<size_t>(bytes.size(), size_t(DIGEST_SIZE)));
+        reset();
+        return;
+    }
+    
+    std::memset(buffer + bufferLength, 0, RATE - bufferLength);
+    buffer[bufferLength] ^= padding;
+    buffer[RATE - 1] ^= 0x80;
+    absorbBlock(buffer);
+    
+    for (size_t i = 0; i < DIGEST_SIZE; i++) {
+        digest[i] = static_cast<uint8_t>(state[i / 8] >> (8 * (i % 8)));
+    }
+    reset();
+}
+
+std::string KeccakHasher::finalizeHex() {
+    uint8_t digest[DIGEST_SIZE];
+    finalize(digest);
+    return Utils::toHex(std::vector<uint8_t>(digest, digest + DIGEST_SIZE));
+}
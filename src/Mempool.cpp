@@ -0,0 +1,396 @@
+#include "../include/Mempool.h"
+#include <algorithm>
+
+Mempool::Mempool(size_t maxMemoryBytes)
+    : maxMemory(maxMemoryBytes), memoryUsage(0), nextSequence(0) {
+}
+
+std::string Mempool::outpointKey(const std::string& txHash, uint32_t outputIndex) {
+    return txHash + ":" + std::to_string(outputIndex);
+}
+
+std::unordered_set<std::string> Mempool::collectAncestors(const Entry& entry) const {
+    std::unordered_set<std::string> ancestors;
+    std::vector<std::string> stack(entry.parents.begin(), entry.parents.end());
+    
+    while (!stack.empty()) {
+        std::string hash = std::move(stack.back());
+        stack.pop_back();
+        if (!ancestors.insert(hash).second) continue;
+        
+        const Entry& parent = entries.at(hash);
+        stack.insert(stack.end(), parent.parents.begin(), parent.parents.end());
+    }
+    return ancestors;
+}
+
+std::unordered_set<std::string> Mempool::collectDescendants(const Entry& entry) const {
+    std::unordered_set<std::string> descendants;
+    std::vector<std::string> stack(entry.children.begin(), entry.children.end());
+    
+    while (!stack.empty()) {
+        std::string hash = std::move(stack.back());
+        stack.pop_back();
+        if (!descendants.insert(hash).second) continue;
+        
+        const Entry& child = entries.at(hash);
+        stack.insert(stack.end(), child.children.begin(), child.children.end());
+    }
+    return descendants;
+}
+
+void Mempool::unindex(const Entry& entry) {
+    byAncestorScore.erase({entry.ancestorFeeRate(), entry.sequence, entry.hash});
+    byDescendantScore.erase({entry.descendantFeeRate(), entry.sequence, entry.hash});
+}
+
+void Mempool::reindex(const Entry& entry) {
+    byAncestorScore.insert({entry.ancestorFeeRate(), entry.sequence, entry.hash});
+    byDescendantScore.insert({entry.descendantFeeRate(), entry.sequence, entry.hash});
+}
+
+Mempool::AddResult Mempool::add(const Transaction& tx, const CoinLookup& lookupCoin) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    const std::string& hash = tx.getHash();
+    if (entries.count(hash)) {
+        return AddResult::ALREADY_KNOWN;
+    }
+    
+    // Coinbase transactions only exist inside blocks
+    if (tx.isCoinbaseTransaction() || tx.getInputs().empty() || tx.getOutputs().empty()) {
+        return AddResult::INVALID;
+    }
+    
+    Entry entry;
+    entry.hash = hash;
+    entry.size = tx.serialize().size();
+    
+    double inputTotal = 0.0;
+    
+    // Outpoint conflicts, both within the transaction and against the pool
+    std::unordered_set<std::string> spends;
+    for (const auto& input : tx.getInputs()) {
+        std::string outpoint = outpointKey(input.txHash, input.outputIndex);
+        if (!spends.insert(outpoint).second) {
+            return AddResult::INVALID;
+        }
+        if (spentOutpoints.count(outpoint)) {
+            return AddResult::CONFLICT;
+        }
+        
+        auto parent = entries.find(input.txHash);
+        if (parent != entries.end()) {
+            const auto& parentOutputs = parent->second.tx.getOutputs();
+            if (input.outputIndex >= parentOutputs.size()) {
+                return AddResult::INVALID;
+            }
+            inputTotal += parentOutputs[input.outputIndex].amount;
+            entry.parents.insert(input.txHash);
+        } else {
+            TransactionOutput coin;
+            if (!lookupCoin || !lookupCoin(input.txHash, input.outputIndex, coin)) {
+                return AddResult::MISSING_INPUTS;
+            }
+            inputTotal += coin.amount;
+        }
+    }
+    
+    double outputTotal = 0.0;
+    for (const auto& output : tx.getOutputs()) {
+        outputTotal += output.amount;
+    }
+    entry.fee = inputTotal - outputTotal;
+    if (entry.fee < -0.00000001) {
+        return AddResult::INVALID;
+    }
+    if (entry.fee < 0.0) {
+        entry.fee = 0.0;
+    }
+    
+    std::unordered_set<std::string> ancestors = collectAncestors(entry);
+    if (ancestors.size() + 1 > MAX_PACKAGE_COUNT) {
+        return AddResult::TOO_LONG_CHAIN;
+    }
+    
+    entry.ancestorFee = entry.fee;
+    entry.ancestorSize = entry.size;
+    entry.ancestorCount = 1;
+    for (const auto& ancestorHash : ancestors) {
+        const Entry& ancestor = entries.at(ancestorHash);
+        if (ancestor.descendantCount + 1 > MAX_PACKAGE_COUNT) {
+            return AddResult::TOO_LONG_CHAIN;
+        }
+        entry.ancestorFee += ancestor.fee;
+        entry.ancestorSize += ancestor.size;
+        entry.ancestorCount++;
+    }
+    entry.descendantFee = entry.fee;
+    entry.descendantSize = entry.size;
+    entry.descendantCount = 1;
+    
+    entry.tx = tx;
+    entry.sequence = nextSequence++;
+    entry.memoryUsage = sizeof(Entry) + entry.size +
+                        tx.getInputs().size() * sizeof(TransactionInput) +
+                        tx.getOutputs().size() * sizeof(TransactionOutput);
+    
+    // Link into the pool
+    for (const auto& outpoint : spends) {
+        spentOutpoints[outpoint] = hash;
+    }
+    for (const auto& parentHash : entry.parents) {
+        entries.at(parentHash).children.insert(hash);
+    }
+    for (const auto& ancestorHash : ancestors) {
+        Entry& ancestor = entries.at(ancestorHash);
+        unindex(ancestor);
+        ancestor.descendantFee += entry.fee;
+        ancestor.descendantSize += entry.size;
+        ancestor.descendantCount++;
+        reindex(ancestor);
+    }
+    
+    memoryUsage += entry.memoryUsage;
+    const Entry& stored = entries.emplace(hash, std::move(entry)).first->second;
+    reindex(stored);
+    
+    trimToBudget();
+    return entries.count(hash) ? AddResult::ADDED : AddResult::MEMPOOL_FULL;
+}
+
+void Mempool::removeEntry(const std::string& txHash) {
+    auto found = entries.find(txHash);
+    if (found == entries.end()) return;
+    const Entry& entry = found->second;
+    
+    // Package totals of everything still linked to this entry no longer include it
+    for (const auto& ancestorHash : collectAncestors(entry)) {
+        Entry& ancestor = entries.at(ancestorHash);
+        unindex(ancestor);
+        ancestor.descendantFee -= entry.fee;
+        ancestor.descendantSize -= entry.size;
+        ancestor.descendantCount--;
+        reindex(ancestor);
+    }
+    for (const auto& descendantHash : collectDescendants(entry)) {
+        Entry& descendant = entries.at(descendantHash);
+        unindex(descendant);
+        descendant.ancestorFee -= entry.fee;
+        descendant.ancestorSize -= entry.size;
+        descendant.ancestorCount--;
+        reindex(descendant);
+    }
+    
+    for (const auto& parentHash : entry.parents) {
+        entries.at(parentHash).children.erase(txHash);
+    }
+    for (const auto& childHash : entry.children) {
+        entries.at(childHash).parents.erase(txHash);
+    }
+    for (const auto& input : entry.tx.getInputs()) {
+        auto spent = spentOutpoints.find(outpointKey(input.txHash, input.outputIndex));
+        if (spent != spentOutpoints.end() && spent->second == txHash) {
+            spentOutpoints.erase(spent);
+        }
+    }
+    
+    unindex(entry);
+    memoryUsage -= entry.memoryUsage;
+    entries.erase(found);
+}
+
+void Mempool::removeWithDescendants(const std::string& txHash) {
+    auto found = entries.find(txHash);
+    if (found == entries.end()) return;
+    
+    // Deepest entries first so no removal leaves an orphaned child behind
+    std::unordered_set<std::string> descendants = collectDescendants(found->second);
+    std::vector<std::string> doomed(descendants.begin(), descendants.end());
+    std::sort(doomed.begin(), doomed.end(), [this](const std::string& a, const std::string& b) {
+        return entries.at(a).ancestorCount > entries.at(b).ancestorCount;
+    });
+    doomed.push_back(txHash);
+    
+    for (const auto& hash : doomed) {
+        removeEntry(hash);
+    }
+}
+
+bool Mempool::remove(const std::string& txHash) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!entries.count(txHash)) return false;
+    removeWithDescendants(txHash);
+    return true;
+}
+
+void Mempool::removeForBlock(const std::vector<Transaction>& blockTransactions) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    for (const auto& tx : blockTransactions) {
+        // Confirmed: drop just this entry, its children stay valid
+        if (entries.count(tx.getHash())) {
+            removeEntry(tx.getHash());
+            continue;
+        }
+        
+        // Anything else spending the same outpoints can never confirm now
+        for (const auto& input : tx.getInputs()) {
+            auto spent = spentOutpoints.find(outpointKey(input.txHash, input.outputIndex));
+            if (spent != spentOutpoints.end()) {
+                std::string conflict = spent->second;
+                removeWithDescendants(conflict);
+            }
+        }
+    }
+}
+
+void Mempool::trimToBudget() {
+    // Evict the package with the lowest descendant fee rate until we fit
+    while (memoryUsage > maxMemory && !byDescendantScore.empty()) {
+        std::string victim = byDescendantScore.begin()->hash;
+        removeWithDescendants(victim);
+    }
+}
+
+std::vector<Transaction> Mempool::selectForBlock(size_t maxBytes, size_t maxCount) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    std::vector<Transaction> selected;
+    std::unordered_set<std::string> inBlock;
+    std::unordered_set<std::string> failed;
+    
+    // Entries whose ancestor totals changed because some ancestors are already in the block
+    struct Modified {
+        double fee;
+        size_t size;
+    };
+    std::unordered_map<std::string, Modified> modified;
+    std::set<ScoreKey, HigherScoreFirst> modifiedQueue;
+    
+    size_t blockBytes = 0;
+    size_t consecutiveFailures = 0;
+    auto it = byAncestorScore.begin();
+    
+    while (selected.size() < maxCount) {
+        while (it != byAncestorScore.end() &&
+               (inBlock.count(it->hash) || modified.count(it->hash) || failed.count(it->hash))) {
+            ++it;
+        }
+        
+        // Best of the untouched index and the modified queue
+        bool fromModified;
+        if (it == byAncestorScore.end()) {
+            if (modifiedQueue.empty()) break;
+            fromModified = true;
+        } else {
+            fromModified = !modifiedQueue.empty() && HigherScoreFirst()(*modifiedQueue.begin(), *it);
+        }
+        ScoreKey candidate = fromModified ? *modifiedQueue.begin() : *it;
+        const Entry& entry = entries.at(candidate.hash);
+        
+        size_t packageSize = fromModified ? modified.at(candidate.hash).size : entry.ancestorSize;
+        std::vector<std::string> package;
+        for (const auto& ancestorHash : collectAncestors(entry)) {
+            if (!inBlock.count(ancestorHash)) {
+                package.push_back(ancestorHash);
+            }
+        }
+        package.push_back(candidate.hash);
+        
+        if (blockBytes + packageSize > maxBytes || selected.size() + package.size() > maxCount) {
+            failed.insert(candidate.hash);
+            if (fromModified) {
+                modifiedQueue.erase(modifiedQueue.begin());
+            }
+            // Stop looking once the block is nearly full and nothing fits
+            if (++consecutiveFailures > 1000 && blockBytes + 4000 > maxBytes) break;
+            continue;
+        }
+        consecutiveFailures = 0;
+        
+        // Fewer ancestors first is a valid topological order
+        std::sort(package.begin(), package.end(), [this](const std::string& a, const std::string& b) {
+            return entries.at(a).ancestorCount < entries.at(b).ancestorCount;
+        });
+        
+        for (const auto& hash : package) {
+            const Entry& added = entries.at(hash);
+            selected.push_back(added.tx);
+            inBlock.insert(hash);
+            blockBytes += added.size;
+            
+            auto mod = modified.find(hash);
+            if (mod != modified.end()) {
+                modifiedQueue.erase({mod->second.fee / mod->second.size, added.sequence, hash});
+                modified.erase(mod);
+            }
+        }
+        
+        // Descendants of what was just added now pay only for their remaining ancestors
+        for (const auto& hash : package) {
+            const Entry& added = entries.at(hash);
+            for (const auto& descendantHash : collectDescendants(added)) {
+                if (inBlock.count(descendantHash) || failed.count(descendantHash)) continue;
+                const Entry& descendant = entries.at(descendantHash);
+                
+                auto mod = modified.find(descendantHash);
+                if (mod == modified.end()) {
+                    mod = modified.emplace(descendantHash, Modified{descendant.ancestorFee, descendant.ancestorSize}).first;
+                } else {
+                    modifiedQueue.erase({mod->second.fee / mod->second.size, descendant.sequence, descendantHash});
+                }
+                mod->second.fee -= added.fee;
+                mod->second.size -= added.size;
+                modifiedQueue.insert({mod->second.fee / mod->second.size, descendant.sequence, descendantHash});
+            }
+        }
+    }
+    
+    return selected;
+}
+
+bool Mempool::contains(const std::string& txHash) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.count(txHash) > 0;
+}
+
+bool Mempool::get(const std::string& txHash, Transaction& tx) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(txHash);
+    if (found == entries.end()) return false;
+    tx = found->second.tx;
+    return true;
+}
+
+std::string Mempool::getSpender(const std::string& txHash, uint32_t outputIndex) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto spent = spentOutpoints.find(outpointKey(txHash, outputIndex));
+    return spent != spentOutpoints.end() ? spent->second : "";
+}
+
+void Mempool::forEach(const std::function<void(const std::string&, const Transaction&)>& visit) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& entry : entries) {
+        visit(entry.first, entry.second.tx);
+    }
+}
+
+size_t Mempool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t Mempool::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return memoryUsage;
+}
+
+double Mempool::getMinFeeRate() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Below budget anything is accepted; at budget a newcomer must beat the cheapest package
+    if (memoryUsage < maxMemory || byDescendantScore.empty()) {
+        return 0.0;
+    }
+    return byDescendantScore.begin()->score;
+}
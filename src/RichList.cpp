@@ -0,0 +1,173 @@
+#include "../include/RichList.h"
+#include "../include/Logger.h"
+#include <leveldb/db.h>
+#include <leveldb/write_batch.h>
+#include <algorithm>
+#include <memory>
+
+RichList::RichList(const std::string& prefix) : prefix(prefix) {
+}
+
+std::string RichList::key(const std::string& address, Amount balance) const {
+    // Fixed-width hex of the inverted balance: ascending keys are descending balances
+    static const char digits[] = "0123456789abcdef";
+    uint64_t inverted = UINT64_MAX - static_cast<uint64_t>(balance);
+    
+    std::string result;
+    result.reserve(prefix.size() + 17 + address.size());
+    result.append(prefix);
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        result.push_back(digits[(inverted >> shift) & 0xf]);
+    }
+    result.push_back(':');
+    result.append(address);
+    return result;
+}
+
+bool RichList::load(leveldb::DB* db, const leveldb::ReadOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tree.clear();
+    balances.clear();
+    
+    try {
+        std::unique_ptr<leveldb::Iterator> it(db->NewIterator(options));
+        for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
+            // <prefix><16 hex digits>:<address>
+            std::string keyData = it->key().ToString();
+            if (keyData.size() < prefix.size() + 17) continue;
+            
+            std::string address = keyData.substr(prefix.size() + 17);
+            Amount balance = static_cast<Amount>(UINT64_MAX - std::stoull(keyData.substr(prefix.size(), 16), nullptr, 16));
+            setLocked(address, balance);
+        }
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Failed to load rich list: " + std::string(e.what()));
+        return false;
+    }
+    
+    LOG_DATABASE(LogLevel::INFO, "Loaded rich list with " + std::to_string(balances.size()) + " addresses");
+    return true;
+}
+
+std::vector<std::pair<std::string, Amount>> RichList::stage(leveldb::WriteBatch& batch,
+                                                            const std::map<std::string, Amount>& deltas) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<std::string, Amount>> updated;
+    updated.reserve(deltas.size());
+    
+    for (const auto& delta : deltas) {
+        if (delta.second == 0) continue;
+        
+        auto found = balances.find(delta.first);
+        Amount previous = found != balances.end() ? found->second : 0;
+        Amount balance = previous + delta.second;
+        
+        if (previous > 0) {
+            batch.Delete(key(delta.first, previous));
+        }
+        if (balance > 0) {
+            batch.Put(key(delta.first, balance), leveldb::Slice());
+        }
+        updated.emplace_back(delta.first, balance);
+    }
+    return updated;
+}
+
+void RichList::apply(const std::vector<std::pair<std::string, Amount>>& updated) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& entry : updated) {
+        setLocked(entry.first, entry.second);
+    }
+}
+
+void RichList::setLocked(const std::string& address, Amount balance) {
+    auto found = balances.find(address);
+    if (found != balances.end()) {
+        tree.erase(TreeKey(-found->second, address));
+        if (balance > 0) {
+            found->second = balance;
+        } else {
+            balances.erase(found);
+        }
+    } else if (balance > 0) {
+        balances.emplace(address, balance);
+    }
+    
+    // Zero and (after a bad reorg) negative balances are not listed
+    if (balance > 0) {
+        tree.insert(TreeKey(-balance, address));
+    }
+}
+
+void RichList::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    tree.clear();
+    balances.clear();
+}
+
+std::vector<RichListEntry> RichList::top(size_t count, size_t offset) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<RichListEntry> entries;
+    if (offset >= balances.size()) return entries;
+    
+    // One O(log n) descent to the first entry, then in-order steps
+    auto it = tree.lower_bound(tree.at(offset));
+    for (size_t rank = offset + 1; it != tree.end() && entries.size() < count; ++it, ++rank) {
+        RichListEntry entry;
+        entry.address = it->second;
+        entry.balance = -it->first;
+        entry.rank = rank;
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+bool RichList::rank(const std::string& address, RichListEntry& entry) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = balances.find(address);
+    if (found == balances.end()) return false;
+    
+    entry.address = address;
+    entry.balance = found->second;
+    entry.rank = tree.before(TreeKey(-found->second, address)).count + 1;
+    return true;
+}
+
+std::vector<RichListBucket> RichList::histogram(const std::vector<Amount>& thresholds) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<RichListBucket> buckets;
+    if (thresholds.empty()) return buckets;
+    
+    // at(i): addresses and balance total with balance >= thresholds[i]
+    auto atLeast = [this](Amount threshold) {
+        // Keys before (-threshold + 1, "") are exactly those with balance >= threshold
+        return tree.before(TreeKey(-threshold + 1, std::string()));
+    };
+    
+    NodeStats upper = atLeast(thresholds[0]);
+    buckets.reserve(thresholds.size());
+    for (size_t i = 0; i < thresholds.size(); i++) {
+        RichListBucket bucket;
+        bucket.minBalance = thresholds[i];
+        NodeStats above{0, 0};
+        if (i + 1 < thresholds.size()) {
+            bucket.maxBalance = thresholds[i + 1];
+            above = atLeast(thresholds[i + 1]);
+        }
+        bucket.addresses = upper.count - above.count;
+        bucket.total = upper.total - above.total;
+        buckets.push_back(bucket);
+        upper = above;
+    }
+    return buckets;
+}
+
+size_t RichList::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return balances.size();
+}
+
+Amount RichList::totalBalance() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tree.before(TreeKey(0, std::string())).total;
+}
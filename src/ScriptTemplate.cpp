@@ -0,0 +1,115 @@
+#include "../include/ScriptTemplate.h"
+#include "../include/ShardedLruCache.h"
+#include "../include/Crypto.h"
+
+static const std::string_view P2PKH_PREFIX = "OP_DUP OP_HASH160 ";
+static const std::string_view P2PKH_SUFFIX = " OP_EQUALVERIFY OP_CHECKSIG";
+
+static const std::string_view MAINNET_PREFIX = "GXC";
+static const std::string_view TESTNET_PREFIX = "tGXC";
+
+// Lowercase only: accepting both cases would make two different address texts equal
+static int lowerHexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+DecodedAddress DecodedAddress::decode(std::string_view address) {
+    DecodedAddress result;
+
+    std::string_view body;
+    bool testnet = false;
+    if (address.compare(0, TESTNET_PREFIX.size(), TESTNET_PREFIX) == 0) {
+        body = address.substr(TESTNET_PREFIX.size());
+        testnet = true;
+    } else if (address.compare(0, MAINNET_PREFIX.size(), MAINNET_PREFIX) == 0) {
+        body = address.substr(MAINNET_PREFIX.size());
+    } else {
+        result.bytes.assign(address);
+        return result;
+    }
+    result.testnet = testnet;
+
+    if (!body.empty() && body.size() % 2 == 0) {
+        result.bytes.resize(body.size() / 2);
+        bool hex = true;
+        for (size_t i = 0; i < result.bytes.size() && hex; i++) {
+            int high = lowerHexValue(body[2 * i]);
+            int low = lowerHexValue(body[2 * i + 1]);
+            hex = high >= 0 && low >= 0;
+            result.bytes[i] = static_cast<char>((high << 4) | low);
+        }
+        if (hex) {
+            result.form = Form::HEX;
+            return result;
+        }
+    }
+
+    result.bytes.assign(address);
+    return result;
+}
+
+ScriptTemplate ScriptTemplate::classify(std::string_view scriptPubKey) {
+    ScriptTemplate result;
+
+    // Same matching rules as the original text parser: prefix and suffix may appear
+    // anywhere, as long as the suffix follows the prefix
+    size_t startPos = scriptPubKey.find(P2PKH_PREFIX);
+    size_t endPos = scriptPubKey.find(P2PKH_SUFFIX);
+    if (startPos != std::string_view::npos && endPos != std::string_view::npos && endPos > startPos) {
+        size_t addressPos = startPos + P2PKH_PREFIX.size();
+        if (endPos >= addressPos) {
+            result.type = Type::P2PKH;
+            result.address = DecodedAddress::decode(scriptPubKey.substr(addressPos, endPos - addressPos));
+        }
+        return result;
+    }
+
+    if (scriptPubKey.find("OP_") == std::string_view::npos) {
+        result.type = Type::BARE_ADDRESS;
+        result.address = DecodedAddress::decode(scriptPubKey);
+    }
+    return result;
+}
+
+namespace {
+    // Keyed by network tag + public key so testnet and mainnet derivations never alias
+    ShardedLruCache<std::string, std::shared_ptr<const DecodedAddress>>& derivationCache() {
+        static ShardedLruCache<std::string, std::shared_ptr<const DecodedAddress>> cache(AddressCache::DEFAULT_CAPACITY);
+        return cache;
+    }
+}
+
+namespace AddressCache {
+
+std::shared_ptr<const DecodedAddress> derive(const std::string& publicKey, bool testnet) {
+    std::string key;
+    key.reserve(publicKey.size() + 1);
+    key.push_back(testnet ? 't' : 'm');
+    key.append(publicKey);
+
+    std::shared_ptr<const DecodedAddress> address;
+    if (derivationCache().get(key, address)) {
+        return address;
+    }
+
+    address = std::make_shared<const DecodedAddress>(
+        DecodedAddress::decode(Crypto::generateAddress(publicKey, testnet)));
+    derivationCache().put(key, address);
+    return address;
+}
+
+bool matches(const std::string& publicKey, const DecodedAddress& address) {
+    return *derive(publicKey, address.testnet) == address;
+}
+
+double hitRate() {
+    return derivationCache().getStats().hitRate();
+}
+
+void clear() {
+    derivationCache().clear();
+}
+
+}
@@ -0,0 +1,88 @@
+#include "../include/SignatureCache.h"
+#include "../include/KeccakHasher.h"
+#include <openssl/rand.h>
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+SignatureCache::SignatureCache(size_t capacity)
+    : shardCapacity(std::max<size_t>(1, capacity / SHARD_COUNT)),
+      hits(0), misses(0), insertions(0), evictions(0) {
+    // The salt keeps peers from predicting keys, so it must come from the OS-seeded CSPRNG
+    if (RAND_bytes(salt.data(), static_cast<int>(salt.size())) != 1) {
+        throw std::runtime_error("SignatureCache: no secure randomness for the salt");
+    }
+}
+
+SignatureCache& SignatureCache::instance() {
+    static SignatureCache cache;
+    return cache;
+}
+
+SignatureCache::Key SignatureCache::makeKey(const std::string& message, const std::string& signature,
+                                            const std::string& publicKey) const {
+    KeccakHasher hasher;
+    hasher.update(salt.data(), salt.size());
+    for (const std::string* part : {&message, &signature, &publicKey}) {
+        uint64_t length = part->size();
+        hasher.update(&length, sizeof(length));
+        hasher.update(*part);
+    }
+    
+    Key key;
+    hasher.finalize(key.data());
+    return key;
+}
+
+bool SignatureCache::contains(const Key& key) {
+    Shard& shard = shardFor(key);
+    bool found;
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        found = shard.entries.count(key) > 0;
+    }
+    (found ? hits : misses).fetch_add(1, std::memory_order_relaxed);
+    return found;
+}
+
+void SignatureCache::insert(const Key& key) {
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    
+    if (!shard.entries.insert(key).second) return;
+    insertions.fetch_add(1, std::memory_order_relaxed);
+    
+    if (shard.order.size() < shardCapacity) {
+        shard.order.push_back(key);
+        return;
+    }
+    
+    // Full: overwrite the oldest slot
+    shard.entries.erase(shard.order[shard.next]);
+    shard.order[shard.next] = key;
+    shard.next = (shard.next + 1) % shardCapacity;
+    evictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SignatureCache::clear() {
+    for (auto& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.entries.clear();
+        shard.order.clear();
+        shard.next = 0;
+    }
+}
+
+SignatureCache::Stats SignatureCache::getStats() const {
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.insertions = insertions;
+    stats.evictions = evictions;
+    stats.capacity = shardCapacity * SHARD_COUNT;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        stats.entries += shard.entries.size();
+    }
+    return stats;
+}
@@ -0,0 +1,87 @@
+#include "../include/SignatureVerifier.h"
+#include "../include/Crypto.h"
+#include "../include/SignatureCache.h"
+#include <atomic>
+#include <mutex>
+
+SignatureVerifier::SignatureVerifier(ThreadPool& pool) : pool(pool) {
+}
+
+SignatureVerificationResult SignatureVerifier::verify(const std::vector<Transaction>& transactions) const {
+    std::vector<const Transaction*> pointers;
+    pointers.reserve(transactions.size());
+    for (const auto& tx : transactions) {
+        pointers.push_back(&tx);
+    }
+    return verify(pointers);
+}
+
+SignatureVerificationResult SignatureVerifier::verify(const std::vector<const Transaction*>& transactions) const {
+    // Flatten to one entry per input so work splits evenly regardless of tx shape
+    struct Check {
+        size_t txIndex;
+        size_t inputIndex;
+    };
+    std::vector<Check> checks;
+    for (size_t t = 0; t < transactions.size(); t++) {
+        const Transaction& tx = *transactions[t];
+        if (tx.isCoinbaseTransaction()) continue;
+        for (size_t i = 0; i < tx.getInputs().size(); i++) {
+            checks.push_back({t, i});
+        }
+    }
+    
+    SignatureCache& cache = SignatureCache::instance();
+    SignatureVerificationResult result;
+    std::atomic<bool> failed(false);
+    std::atomic<size_t> checked(0);
+    std::mutex resultMutex;
+    size_t firstFailure = checks.size();
+    
+    pool.parallelFor(checks.size(), CHECKS_PER_TASK, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            if (failed.load(std::memory_order_relaxed)) return;
+            
+            const Transaction& tx = *transactions[checks[c].txIndex];
+            const TransactionInput& input = tx.getInputs()[checks[c].inputIndex];
+            
+            const char* error = nullptr;
+            if (input.signature.empty()) {
+                error = "missing signature";
+            } else if (input.publicKey.empty()) {
+                error = "missing public key";
+            } else {
+                // Signatures seen at mempool entry are not checked again
+                std::string message = Transaction::signatureMessage(input);
+                SignatureCache::Key key = cache.makeKey(message, input.signature, input.publicKey);
+                if (!cache.contains(key)) {
+                    if (Crypto::verifySignature(message, input.signature, input.publicKey)) {
+                        cache.insert(key);
+                    } else {
+                        error = "invalid signature";
+                    }
+                }
+            }
+            checked++;
+            
+            if (error) {
+                failed = true;
+                std::lock_guard<std::mutex> lock(resultMutex);
+                if (c < firstFailure) {
+                    firstFailure = c;
+                    result.error = error;
+                }
+                return;
+            }
+        }
+    });
+    
+    result.checked = checked;
+    if (failed) {
+        result.valid = false;
+        result.txIndex = checks[firstFailure].txIndex;
+        result.inputIndex = checks[firstFailure].inputIndex;
+        result.txHash = transactions[result.txIndex]->getHash();
+    }
+    return result;
+}
@@ -0,0 +1,123 @@
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <exception>
+
+ThreadPool::ThreadPool(size_t threadCount) : stopping(false), queuedTasks(0) {
+    if (threadCount == 0) {
+        threadCount = std::max<unsigned>(1, std::thread::hardware_concurrency());
+    }
+    
+    // Slot 0 belongs to callers of parallelFor; workers use 1..threadCount
+    for (size_t i = 0; i <= threadCount; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (size_t i = 1; i <= threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+bool ThreadPool::popTask(size_t index, Task& task) {
+    WorkQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queuedTasks--;
+    return true;
+}
+
+bool ThreadPool::stealTask(size_t thief, Task& task) {
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        WorkQueue& victim = *queues[(thief + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queuedTasks--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    while (true) {
+        Task task;
+        if (popTask(index, task) || stealTask(index, task)) {
+            task();
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeup.wait(lock, [this] { return stopping || queuedTasks > 0; });
+        if (stopping) return;
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) return;
+    grain = std::max<size_t>(1, grain);
+    
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || workers.empty()) {
+        body(0, count);
+        return;
+    }
+    
+    std::atomic<size_t> remaining(chunks);
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    
+    // Deal chunks round-robin across the worker queues
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        size_t begin = chunk * grain;
+        size_t end = std::min(count, begin + grain);
+        WorkQueue& queue = *queues[1 + chunk % workers.size()];
+        
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.emplace_back([&, begin, end]() {
+            try {
+                body(begin, end);
+            } catch (...) {
+                std::lock_guard<std::mutex> errorLock(errorMutex);
+                if (!error) error = std::current_exception();
+            }
+            remaining--;
+        });
+        queuedTasks++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeup.notify_all();
+    
+    // Help out until everything has been claimed, then wait for stragglers
+    while (remaining > 0) {
+        Task task;
+        if (stealTask(0, task)) {
+            task();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
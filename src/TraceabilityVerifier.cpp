@@ -0,0 +1,308 @@
+#include "../include/TraceabilityVerifier.h"
+#include "../include/Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <unordered_map>
+
+// Same tolerance as Transaction::verifyTraceabilityFormula
+static const double AMOUNT_EPSILON = 0.00000001;
+
+// Outputs of a referenced transaction and the height of its block
+struct TraceabilityVerifier::Referenced {
+    std::vector<TransactionOutput> outputs;
+    uint32_t blockHeight = 0;
+};
+
+// Transactions of the block being checked, by hash, with their positions. A
+// reference into the same block must point at an earlier position.
+struct TraceabilityVerifier::BlockContext {
+    std::unordered_map<std::string, size_t> positions;
+    const std::vector<Transaction>* transactions = nullptr;
+};
+
+TraceabilityVerifier::TraceabilityVerifier(Database& db, ThreadPool& pool)
+    : db(db), pool(pool), auditRunning(false), stopRequested(false), auditFrom(0), auditTo(0),
+      auditHeight(0), auditBlocks(0), auditTransactions(0), auditLinks(0), auditIssues(0) {
+}
+
+TraceabilityVerifier::~TraceabilityVerifier() {
+    stopAudit();
+}
+
+bool TraceabilityVerifier::checkTransaction(const Transaction& tx, uint32_t blockHeight, const BlockContext* context,
+                                            size_t position, bool checkTraceRecord, TraceabilityIssue& issue,
+                                            uint64_t& links) const {
+    issue.txHash = tx.getHash();
+    issue.blockHeight = blockHeight;
+    issue.inputIndex = 0;
+    
+    if (tx.isCoinbaseTransaction() || tx.isGenesis()) return true;
+    
+    if (!tx.verifyTraceabilityFormula()) {
+        issue.reason = "traceability formula does not hold";
+        return false;
+    }
+    
+    // Inputs often share a funding transaction; load each one once
+    std::unordered_map<std::string, Referenced> referenced;
+    const auto& inputs = tx.getInputs();
+    for (size_t i = 0; i < inputs.size(); i++) {
+        const TransactionInput& input = inputs[i];
+        issue.inputIndex = i;
+        links++;
+        
+        auto found = referenced.find(input.txHash);
+        if (found == referenced.end()) {
+            Referenced ref;
+            bool exists = false;
+            
+            auto inBlock = context ? context->positions.find(input.txHash) : std::unordered_map<std::string, size_t>::const_iterator();
+            if (context && inBlock != context->positions.end()) {
+                if (inBlock->second >= position) {
+                    issue.reason = "references a transaction later in the same block";
+                    return false;
+                }
+                ref.outputs = (*context->transactions)[inBlock->second].getOutputs();
+                ref.blockHeight = blockHeight;
+                exists = true;
+            } else {
+                std::string blockHash;
+                if (db.getTransactionLocation(input.txHash, blockHash, ref.blockHeight)) {
+                    ref.outputs = db.getTransactionOutputs(input.txHash);
+                    exists = !ref.outputs.empty();
+                }
+            }
+            
+            if (!exists) {
+                issue.reason = "referenced transaction " + input.txHash + " not found";
+                return false;
+            }
+            found = referenced.emplace(input.txHash, std::move(ref)).first;
+        }
+        
+        const Referenced& ref = found->second;
+        if (ref.blockHeight > blockHeight) {
+            issue.reason = "references a transaction in a later block";
+            return false;
+        }
+        if (input.outputIndex >= ref.outputs.size()) {
+            issue.reason = "referenced output " + std::to_string(input.outputIndex) + " does not exist";
+            return false;
+        }
+        if (std::abs(ref.outputs[input.outputIndex].amount - input.amount) > AMOUNT_EPSILON) {
+            issue.reason = "input amount does not match referenced output";
+            return false;
+        }
+    }
+    
+    if (checkTraceRecord) {
+        issue.inputIndex = 0;
+        TraceabilityRecord record;
+        if (!db.getTraceabilityRecord(tx.getHash(), record)) {
+            issue.reason = "missing trace record";
+            return false;
+        }
+        if (record.prevTxHash != tx.getPrevTxHash() ||
+            std::abs(record.referencedAmount - tx.getReferencedAmount()) > AMOUNT_EPSILON) {
+            issue.reason = "trace record does not match transaction";
+            return false;
+        }
+        if (record.blockHeight != blockHeight) {
+            issue.reason = "trace record block height " + std::to_string(record.blockHeight) + " does not match";
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+TraceabilityVerifier::Result TraceabilityVerifier::verifyBlock(const Block& block) const {
+    const auto& transactions = block.getTransactions();
+    
+    BlockContext context;
+    context.transactions = &transactions;
+    for (size_t t = 0; t < transactions.size(); t++) {
+        context.positions.emplace(transactions[t].getHash(), t);
+    }
+    
+    Result result;
+    std::atomic<bool> failed(false);
+    std::atomic<uint64_t> links(0);
+    std::mutex resultMutex;
+    size_t firstFailure = transactions.size();
+    
+    pool.parallelFor(transactions.size(), TRANSACTIONS_PER_TASK, [&](size_t begin, size_t end) {
+        uint64_t localLinks = 0;
+        for (size_t t = begin; t < end && !failed.load(std::memory_order_relaxed); t++) {
+            TraceabilityIssue issue;
+            if (!checkTransaction(transactions[t], block.getIndex(), &context, t, false, issue, localLinks)) {
+                failed = true;
+                std::lock_guard<std::mutex> lock(resultMutex);
+                if (t < firstFailure) {
+                    firstFailure = t;
+                    result.issue = std::move(issue);
+                }
+            }
+        }
+        links += localLinks;
+    });
+    
+    result.linksChecked = links;
+    if (failed) {
+        result.valid = false;
+        result.txIndex = firstFailure;
+    }
+    return result;
+}
+
+bool TraceabilityVerifier::startAudit(uint32_t fromHeight, uint32_t toHeight, size_t auditThreads) {
+    if (auditRunning.exchange(true)) return false;
+    if (auditThread.joinable()) auditThread.join();
+    
+    stopRequested = false;
+    auditFrom = fromHeight;
+    auditTo = toHeight;
+    auditHeight = fromHeight;
+    auditBlocks = 0;
+    auditTransactions = 0;
+    auditLinks = 0;
+    auditIssues = 0;
+    {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        report = TraceabilityAuditReport();
+        report.fromHeight = fromHeight;
+        report.toHeight = toHeight;
+    }
+    
+    auditThread = std::thread(&TraceabilityVerifier::runAudit, this, fromHeight, toHeight, auditThreads);
+    return true;
+}
+
+void TraceabilityVerifier::stopAudit() {
+    stopRequested = true;
+    if (auditThread.joinable()) auditThread.join();
+}
+
+void TraceabilityVerifier::recordIssue(const TraceabilityIssue& issue) {
+    auditIssues++;
+    std::lock_guard<std::mutex> lock(reportMutex);
+    if (report.issues.size() < MAX_REPORTED_ISSUES) {
+        report.issues.push_back(issue);
+    }
+}
+
+void TraceabilityVerifier::runAudit(uint32_t fromHeight, uint32_t toHeight, size_t auditThreads) {
+    auto started = std::chrono::steady_clock::now();
+    if (auditThreads == 0) {
+        auditThreads = std::max<size_t>(1, std::thread::hardware_concurrency() / 4);
+    }
+    ThreadPool auditPool(auditThreads);
+    
+    LOG_DATABASE(LogLevel::INFO, "Traceability audit started for heights " + std::to_string(fromHeight) +
+                 "-" + std::to_string(toHeight));
+    
+    // Blocks are loaded on this thread and checked in batches of about
+    // AUDIT_BATCH_TRANSACTIONS transactions across the audit pool
+    struct Item {
+        const Transaction* tx;
+        uint32_t height;
+        const BlockContext* context;
+        size_t position;
+    };
+    std::deque<Block> blocks;   // deques so batch pointers survive push_back
+    std::deque<BlockContext> contexts;
+    std::vector<Item> batch;
+    
+    auto flush = [&]() {
+        auditPool.parallelFor(batch.size(), TRANSACTIONS_PER_TASK, [&](size_t begin, size_t end) {
+            uint64_t localLinks = 0;
+            for (size_t i = begin; i < end; i++) {
+                TraceabilityIssue issue;
+                if (!checkTransaction(*batch[i].tx, batch[i].height, batch[i].context, batch[i].position, true,
+                                      issue, localLinks)) {
+                    recordIssue(issue);
+                }
+            }
+            auditLinks += localLinks;
+        });
+        auditTransactions += batch.size();
+        auditBlocks += blocks.size();
+        batch.clear();
+        blocks.clear();
+        contexts.clear();
+    };
+    
+    bool stopped = false;
+    for (uint64_t height = fromHeight; height <= toHeight; height++) {
+        if (stopRequested) {
+            stopped = true;
+            break;
+        }
+        
+        Block block;
+        if (!db.getBlock(static_cast<uint32_t>(height), block)) {
+            TraceabilityIssue issue;
+            issue.blockHeight = static_cast<uint32_t>(height);
+            issue.reason = "block not found";
+            recordIssue(issue);
+            auditBlocks++;
+            continue;
+        }
+        
+        // Same-block references are ordered exactly as during block connect; hashes are
+        // computed here, before the transactions are shared with the audit pool
+        blocks.push_back(std::move(block));
+        const auto& transactions = blocks.back().getTransactions();
+        contexts.emplace_back();
+        BlockContext& context = contexts.back();
+        context.transactions = &transactions;
+        for (size_t t = 0; t < transactions.size(); t++) {
+            context.positions.emplace(transactions[t].getHash(), t);
+            batch.push_back({&transactions[t], static_cast<uint32_t>(height), &context, t});
+        }
+        auditHeight = static_cast<uint32_t>(height);
+        
+        if (batch.size() >= AUDIT_BATCH_TRANSACTIONS) {
+            flush();
+        }
+    }
+    if (!batch.empty() || !blocks.empty()) {
+        flush();
+    }
+    
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        report.blocksChecked = auditBlocks;
+        report.transactionsChecked = auditTransactions;
+        report.linksChecked = auditLinks;
+        report.issuesFound = auditIssues;
+        report.completed = !stopped;
+        report.elapsedSeconds = elapsed;
+    }
+    
+    LOG_DATABASE(stopped ? LogLevel::WARNING : LogLevel::INFO,
+                 "Traceability audit " + std::string(stopped ? "stopped" : "finished") + ": " +
+                 std::to_string(auditTransactions.load()) + " transactions, " +
+                 std::to_string(auditIssues.load()) + " issues");
+    auditRunning = false;
+}
+
+TraceabilityVerifier::Progress TraceabilityVerifier::getAuditProgress() const {
+    Progress progress;
+    progress.running = auditRunning;
+    progress.fromHeight = auditFrom;
+    progress.toHeight = auditTo;
+    progress.currentHeight = auditHeight;
+    progress.blocksChecked = auditBlocks;
+    progress.transactionsChecked = auditTransactions;
+    progress.linksChecked = auditLinks;
+    progress.issuesFound = auditIssues;
+    return progress;
+}
+
+TraceabilityAuditReport TraceabilityVerifier::getAuditReport() const {
+    std::lock_guard<std::mutex> lock(reportMutex);
+    return report;
+}
@@ -2,61 +2,77 @@
 #include "../include/HashUtils.h"
 #include "../include/Utils.h"
 #include "../include/Crypto.h"
+#include "../include/KeccakHasher.h"
+#include "../include/KeccakBatch.h"
+#include "../include/SignatureCache.h"
+#include "../include/ScriptTemplate.h"
 #include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <string_view>
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <mutex>
 
 // Default constructor
 Transaction::Transaction() 
     : timestamp(0), referencedAmount(0.0), nonce(0),
       isGoldBacked(false), isCoinbase(false), fee(0.0), lockTime(0), type(TransactionType::NORMAL),
-      workReceiptHash(""), blockHeight(0) {
+      workReceiptHash(""), blockHeight(0), hashDirty(false), validationFlags(0) {
     txHash = "";
     prevTxHash = "";
 }
 
-Transaction::Transaction(const std::vector<TransactionInput>& inputsIn, 
-                        const std::vector<TransactionOutput>& outputsIn,
+// Inputs and outputs are taken by value: callers passing temporaries move them in
+Transaction::Transaction(std::vector<TransactionInput> inputsIn, 
+                        std::vector<TransactionOutput> outputsIn,
                         const std::string& prevTxHashIn)
-    : inputs(inputsIn), outputs(outputsIn), prevTxHash(prevTxHashIn), 
-      isGoldBacked(false), isCoinbase(false), fee(0.0), lockTime(0), type(TransactionType::NORMAL) {
+    : inputs(std::move(inputsIn)), outputs(std::move(outputsIn)), prevTxHash(prevTxHashIn), 
+      isGoldBacked(false), isCoinbase(false), fee(0.0), lockTime(0), type(TransactionType::NORMAL),
+      hashDirty(true), validationFlags(0) {
     timestamp = std::time(nullptr);
     nonce = Utils::randomUint32();
     
+    for (auto& output : outputs) {
+        output.classifyScript();
+    }
+    
     // Set sender and receiver from inputs/outputs
     if (!inputs.empty() && !outputs.empty()) {
         senderAddress = ""; // Would be derived from input signatures
         receiverAddress = outputs[0].address;
         referencedAmount = inputs[0].amount;
     }
-    
-    txHash = calculateHash();
 }
 
-Transaction::Transaction(const std::vector<TransactionInput>& inputsIn, 
-                        const std::vector<TransactionOutput>& outputsIn,
+Transaction::Transaction(std::vector<TransactionInput> inputsIn, 
+                        std::vector<TransactionOutput> outputsIn,
                         const std::string& prevTxHashIn,
                         const std::string& popReferenceIn)
-    : inputs(inputsIn), outputs(outputsIn), prevTxHash(prevTxHashIn), 
-      popReference(popReferenceIn), isGoldBacked(true), isCoinbase(false), fee(0.0), lockTime(0), type(TransactionType::NORMAL) {
+    : inputs(std::move(inputsIn)), outputs(std::move(outputsIn)), prevTxHash(prevTxHashIn), 
+      popReference(popReferenceIn), isGoldBacked(true), isCoinbase(false), fee(0.0), lockTime(0), type(TransactionType::NORMAL),
+      hashDirty(true), validationFlags(0) {
     timestamp = std::time(nullptr);
     nonce = Utils::randomUint32();
     
+    for (auto& output : outputs) {
+        output.classifyScript();
+    }
+    
     if (!inputs.empty() && !outputs.empty()) {
         senderAddress = "";
         receiverAddress = outputs[0].address;
         referencedAmount = inputs[0].amount;
     }
-    
-    txHash = calculateHash();
 }
 
 // Constructor for coinbase transaction
 Transaction::Transaction(const std::string& minerAddress, double blockReward)
     : prevTxHash("0"), referencedAmount(0.0), receiverAddress(minerAddress),
       isGoldBacked(false), isCoinbase(true), fee(0.0), lockTime(0), type(TransactionType::NORMAL),
-      workReceiptHash(""), blockHeight(0) {
+      workReceiptHash(""), blockHeight(0), hashDirty(true), validationFlags(0) {
     timestamp = std::time(nullptr);
     nonce = Utils::randomUint32();
     
@@ -68,41 +84,197 @@ Transaction::Transaction(const std::string& minerAddress, double blockReward)
     output.address = minerAddress;
     output.amount = blockReward;
     output.script = "OP_DUP OP_HASH160 " + minerAddress + " OP_EQUALVERIFY OP_CHECKSIG";
+    output.classifyScript();
     outputs.push_back(output);
-    
-    txHash = calculateHash();
 }
 
-std::string Transaction::calculateHash() const {
-    std::stringstream ss;
-    
+// The txid preimage is the historical text form: every field formatted as
+// operator<< would print it, concatenated without separators. It is streamed
+// straight into the hasher instead of being built up in a stringstream first.
+
+// Collects the preimage bytes for batch hashing, where all messages must exist up front
+struct PreimageBuffer {
+    std::string& out;
+    void update(const void* data, size_t length) { out.append(static_cast<const char*>(data), length); }
+};
+
+template <typename Sink>
+static void putText(Sink& sink, const std::string& value) {
+    sink.update(value.data(), value.size());
+}
+
+template <typename Sink, typename Integer>
+static void putInteger(Sink& sink, Integer value) {
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    sink.update(digits, end - digits);
+}
+
+// operator<<(double) with default flags and precision formats as printf("%g")
+template <typename Sink>
+static void putAmount(Sink& sink, double value) {
+    char text[32];
+    int length = std::snprintf(text, sizeof(text), "%g", value);
+    if (length > 0 && static_cast<size_t>(length) < sizeof(text)) {
+        sink.update(text, length);
+    }
+}
+
+template <typename Sink>
+void Transaction::writePreimage(Sink& sink) const {
     // Include inputs
     for (const auto& input : inputs) {
-        ss << input.txHash << input.outputIndex << input.signature << input.amount << input.publicKey;
+        putText(sink, input.txHash);
+        putInteger(sink, input.outputIndex);
+        putText(sink, input.signature);
+        putAmount(sink, input.amount);
+        putText(sink, input.publicKey);
     }
     
     // Include outputs
     for (const auto& output : outputs) {
-        ss << output.address << output.amount << output.script;
+        putText(sink, output.address);
+        putAmount(sink, output.amount);
+        putText(sink, output.script);
     }
     
     // Include all transaction data for comprehensive hash
-    ss << timestamp << prevTxHash << referencedAmount << senderAddress 
-       << receiverAddress << nonce << fee << memo << lockTime;
+    putInteger(sink, timestamp);
+    putText(sink, prevTxHash);
+    putAmount(sink, referencedAmount);
+    putText(sink, senderAddress);
+    putText(sink, receiverAddress);
+    putInteger(sink, nonce);
+    putAmount(sink, fee);
+    putText(sink, memo);
+    putInteger(sink, lockTime);
     
     // Include type
-    ss << static_cast<int>(type);
-
+    putInteger(sink, static_cast<int>(type));
+    
     // Include special fields
     if (isGoldBacked) {
-        ss << popReference;
+        putText(sink, popReference);
     }
     
     if (isCoinbase) {
-        ss << "COINBASE";
+        sink.update("COINBASE", 8);
+    }
+}
+
+std::string Transaction::calculateHash() const {
+    KeccakHasher hasher;
+    writePreimage(hasher);
+    return hasher.finalizeHex();
+}
+
+// Fills every stale hash in one multi-buffer pass; used where a whole block's worth
+// of transactions is about to be hashed anyway
+void Transaction::computeHashes(const std::vector<const Transaction*>& transactions) {
+    std::vector<const Transaction*> stale;
+    for (const Transaction* tx : transactions) {
+        if (tx->hashDirty.load()) stale.push_back(tx);
+    }
+    if (stale.size() < 2) {
+        for (const Transaction* tx : stale) tx->getHash();
+        return;
+    }
+    
+    std::vector<std::string> preimages(stale.size());
+    for (size_t i = 0; i < stale.size(); i++) {
+        PreimageBuffer buffer{preimages[i]};
+        stale[i]->writePreimage(buffer);
     }
     
-    return keccak256(ss.str());
+    std::vector<std::string> hashes = KeccakBatch::hashHex(preimages);
+    for (size_t i = 0; i < stale.size(); i++) {
+        stale[i]->adoptComputedHash(std::move(hashes[i]));
+    }
+}
+
+// Serializes the lazy hash fill. Striped by address rather than held per
+// transaction, so Transaction stays copyable and costs no mutex of its own.
+static std::mutex& hashFillMutex(const Transaction* tx) {
+    static std::mutex stripes[64];
+    return stripes[(reinterpret_cast<uintptr_t>(tx) >> 6) % 64];
+}
+
+// The hash is computed on first use after a mutation, so building a transaction
+// input by input costs one hash rather than one per call. Mutators are non-const
+// and so never run concurrently with readers; concurrent const readers race only
+// to fill the hash, and the fill happens once under the stripe lock.
+const std::string& Transaction::getHash() const {
+    if (hashDirty.load()) {
+        std::lock_guard<std::mutex> lock(hashFillMutex(this));
+        if (hashDirty.load(std::memory_order_relaxed)) {
+            txHash = calculateHash();
+            hashDirty.store(false);
+        }
+    }
+    return txHash;
+}
+
+void Transaction::adoptComputedHash(std::string&& hash) const {
+    std::lock_guard<std::mutex> lock(hashFillMutex(this));
+    if (hashDirty.load(std::memory_order_relaxed)) {
+        txHash = std::move(hash);
+        hashDirty.store(false);
+    }
+}
+
+void Transaction::setHash(std::string hash) {
+    txHash = std::move(hash);
+    hashDirty.store(false);
+}
+
+// Every mutation of a hashed field goes through here
+void Transaction::invalidate() {
+    hashDirty.store(true);
+    validationFlags.store(0);
+}
+
+void Transaction::setSenderAddress(std::string address) {
+    senderAddress = std::move(address);
+    invalidate();
+}
+
+void Transaction::setReceiverAddress(std::string address) {
+    receiverAddress = std::move(address);
+    invalidate();
+}
+
+void Transaction::setFee(double feeIn) {
+    fee = feeIn;
+    invalidate();
+}
+
+void Transaction::setTimestamp(uint64_t timestampIn) {
+    timestamp = timestampIn;
+    invalidate();
+}
+
+void Transaction::setNonce(uint32_t nonceIn) {
+    nonce = nonceIn;
+    invalidate();
+}
+
+void Transaction::setCoinbaseTransaction(bool coinbase) {
+    isCoinbase = coinbase;
+    invalidate();
+}
+
+void Transaction::setPrevTxHash(std::string prevTxHashIn) {
+    prevTxHash = std::move(prevTxHashIn);
+    invalidate();
+}
+
+void Transaction::setReferencedAmount(double amount) {
+    referencedAmount = amount;
+    invalidate();
+}
+
+bool Transaction::hashMatches(const std::string& hash) const {
+    return hash == calculateHash();
 }
 
 // Core Traceability Verification - Implementing Your Formula
@@ -159,12 +331,35 @@ bool Transaction::validateInputReference() const {
     return true;
 }
 
+// Validation results are cached in validationFlags: storage, RPC and block assembly
+// all ask the same questions of a transaction that has not changed in between.
+// Every mutator clears the cache through invalidate(). The flags are atomic, so
+// const checks on a shared transaction may run concurrently; at worst two threads
+// compute the same verdict and OR in the same bits.
+bool Transaction::cachedCheck(uint8_t checkedBit, uint8_t validBit, bool (Transaction::*check)() const) const {
+    uint8_t flags = validationFlags.load();
+    if (!(flags & checkedBit)) {
+        bool valid = (this->*check)();
+        uint8_t bits = checkedBit | (valid ? validBit : 0);
+        flags = validationFlags.fetchOr(bits) | bits;
+    }
+    return (flags & validBit) != 0;
+}
+
 bool Transaction::isTraceabilityValid() const {
+    return cachedCheck(TRACEABILITY_CHECKED, TRACEABILITY_VALID, &Transaction::computeTraceabilityValid);
+}
+
+bool Transaction::computeTraceabilityValid() const {
     return verifyTraceabilityFormula() && validateInputReference() && 
            validateAmountConsistency() && hasValidPrevReference();
 }
 
 bool Transaction::verifyTransaction() const {
+    return cachedCheck(VERIFIED_CHECKED, VERIFIED_VALID, &Transaction::computeVerifyTransaction);
+}
+
+bool Transaction::computeVerifyTransaction() const {
     // 1. Basic structure validation
     if (outputs.empty()) {
         return false;
@@ -214,6 +409,10 @@ bool Transaction::verifyTransaction() const {
 }
 
 bool Transaction::validateAmountConsistency() const {
+    return cachedCheck(AMOUNTS_CHECKED, AMOUNTS_VALID, &Transaction::computeAmountConsistency);
+}
+
+bool Transaction::computeAmountConsistency() const {
     if (isCoinbase) {
         return true; // Coinbase creates new money
     }
@@ -238,7 +437,8 @@ bool Transaction::validateSignatures() const {
         return true; // Coinbase doesn't need signatures
     }
     
-    // Verify all input signatures
+    // Verify all input signatures; ones already verified (e.g. at mempool entry) are cached
+    SignatureCache& cache = SignatureCache::instance();
     for (const auto& input : inputs) {
         if (input.signature.empty()) {
             return false;
@@ -249,28 +449,61 @@ bool Transaction::validateSignatures() const {
         }
         
         // Verify ECDSA signature
-        std::string message = input.txHash + std::to_string(input.outputIndex) + std::to_string(input.amount);
+        std::string message = signatureMessage(input);
+        SignatureCache::Key key = cache.makeKey(message, input.signature, input.publicKey);
+        if (cache.contains(key)) {
+            continue;
+        }
         if (!Crypto::verifySignature(message, input.signature, input.publicKey)) {
             return false;
         }
+        cache.insert(key);
     }
     
     return true;
 }
 
+// Message committed to by an input's signature
+std::string Transaction::signatureMessage(const TransactionInput& input) {
+    std::string message;
+    appendSignatureMessage(message, input);
+    return message;
+}
+
+// Writes txHash + to_string(outputIndex) + to_string(amount) into a reusable buffer.
+// std::to_string(double) is specified as "%f", so the bytes are identical.
+void Transaction::appendSignatureMessage(std::string& out, const TransactionInput& input) {
+    out.append(input.txHash);
+    
+    char digits[16];
+    out.append(digits, std::to_chars(digits, digits + sizeof(digits), input.outputIndex).ptr);
+    
+    char amount[64];
+    int length = std::snprintf(amount, sizeof(amount), "%f", input.amount);
+    if (length > 0 && static_cast<size_t>(length) < sizeof(amount)) {
+        out.append(amount, length);
+    } else {
+        out.append(std::to_string(input.amount));
+    }
+}
+
+void Transaction::setInputSignature(size_t index, std::string&& signature, const std::string& publicKey) {
+    inputs[index].signature = std::move(signature);
+    inputs[index].publicKey = publicKey;
+    invalidate();
+}
+
 void Transaction::signInputs(const std::string& privateKey) {
     // Proper ECDSA signing with secp256k1
     // Derive public key from private key
     std::string publicKey = Crypto::derivePublicKey(privateKey);
     
     for (auto& input : inputs) {
-        // Create message to sign (transaction data)
-        std::string message = input.txHash + std::to_string(input.outputIndex) + std::to_string(input.amount);
-        
         // Sign with ECDSA
-        input.signature = Crypto::signData(message, privateKey);
+        input.signature = Crypto::signData(signatureMessage(input), privateKey);
         input.publicKey = publicKey;
     }
+    invalidate();
 }
 
 // Utility functions
@@ -307,7 +540,7 @@ std::string Transaction::serialize() const {
     // Serialize basic data
     // Format: txHash|timestamp|prevTxHash|referencedAmount|senderAddress|receiverAddress|nonce|fee|memo|lockTime|isGoldBacked|isCoinbase|type|
     // NOTE: txHash, prevTxHash, addresses are typically hex or base58 which are safe from '|'
-    ss << txHash << "|" << timestamp << "|" << prevTxHash << "|" 
+    ss << getHash() << "|" << timestamp << "|" << prevTxHash << "|" 
        << referencedAmount << "|" << senderAddress << "|" << receiverAddress << "|"
        << nonce << "|" << fee << "|" << safeSerialize(memo) << "|" << lockTime << "|"
        << (isGoldBacked ? "1" : "0") << "|" << (isCoinbase ? "1" : "0") << "|"
@@ -334,108 +567,353 @@ std::string Transaction::serialize() const {
     return ss.str();
 }
 
-bool Transaction::deserialize(const std::string& data) {
-    try {
-        if (data.empty()) return false;
-
-        std::vector<std::string> parts = Utils::split(data, '|');
-        size_t index = 0;
-
-        if (parts.size() < 13) return false; // Minimum required parts
-
-        // Helper to safely deserialize strings
-        auto safeDeserialize = [](const std::string& hexStr) {
-            if (hexStr.empty()) return std::string("");
-            // Check if it looks like hex (basic check)
-            if (Utils::isValidHex(hexStr)) {
-                 std::vector<uint8_t> bytes = Utils::fromHex(hexStr);
-                 return std::string(bytes.begin(), bytes.end());
-            }
-            // Fallback for backward compatibility if it's not hex or legacy format
-            return hexStr;
-        };
-
-        txHash = parts[index++];
-        timestamp = std::stoull(parts[index++]);
-        prevTxHash = parts[index++];
-        referencedAmount = std::stod(parts[index++]);
-        senderAddress = parts[index++];
-        receiverAddress = parts[index++];
-        nonce = std::stoul(parts[index++]);
-        fee = std::stod(parts[index++]);
-
-        // Memo is now hex encoded
-        std::string memoHex = parts[index++];
-        memo = safeDeserialize(memoHex);
-
-        lockTime = std::stoul(parts[index++]);
-        isGoldBacked = (parts[index++] == "1");
-        isCoinbase = (parts[index++] == "1");
-
-        // Handle type field which was added to serialization
-        if (index < parts.size() && Utils::isNumeric(parts[index])) {
-            int typeInt = std::stoi(parts[index++]);
-            type = static_cast<TransactionType>(typeInt);
-        } else {
-            type = TransactionType::NORMAL;
+// Single-pass reader over the '|'-separated serialize() format. Fields are
+// string_views into the input; numbers are parsed in place with from_chars.
+class FieldReader {
+public:
+    explicit FieldReader(std::string_view data) : rest(data), exhausted(data.empty()) {}
+
+    bool next(std::string_view& field) {
+        if (exhausted) return false;
+        size_t pos = rest.find('|');
+        if (pos == std::string_view::npos) {
+            field = rest;
+            rest = std::string_view();
+            exhausted = true;
+            // A trailing '|' leaves nothing after it; that is not a field
+            return !field.empty();
+        }
+        field = rest.substr(0, pos);
+        rest.remove_prefix(pos + 1);
+        exhausted = rest.empty();
+        return true;
+    }
+
+    bool peek(std::string_view& field) const {
+        FieldReader copy = *this;
+        return copy.next(field);
+    }
+
+    bool nextString(std::string& out) {
+        std::string_view field;
+        if (!next(field)) return false;
+        out.assign(field.data(), field.size());
+        return true;
+    }
+
+    // Hex-encoded text fields, with a raw fallback for records written before encoding
+    bool nextEncoded(std::string& out) {
+        std::string_view field;
+        if (!next(field)) return false;
+        if (!isHex(field)) {
+            out.assign(field.data(), field.size());
+            return true;
+        }
+        out.resize(field.size() / 2);
+        for (size_t i = 0; i < out.size(); i++) {
+            out[i] = static_cast<char>((hexValue(field[2 * i]) << 4) | hexValue(field[2 * i + 1]));
         }
+        return true;
+    }
 
-        // Parse inputs
-        if (index >= parts.size()) return false;
-        size_t inputCount = std::stoul(parts[index++]);
-        inputs.clear();
-        for (size_t i = 0; i < inputCount; i++) {
-            if (index + 4 >= parts.size()) return false;
-
-            TransactionInput input;
-            input.txHash = parts[index++];
-            input.outputIndex = std::stoul(parts[index++]);
-            input.signature = parts[index++];
-            input.amount = std::stod(parts[index++]);
-            input.publicKey = parts[index++];
-            inputs.push_back(input);
+    template <typename T>
+    bool nextNumber(T& out) {
+        std::string_view field;
+        if (!next(field) || field.empty()) return false;
+        auto result = std::from_chars(field.data(), field.data() + field.size(), out);
+        return result.ec == std::errc() && result.ptr == field.data() + field.size();
+    }
+
+    static bool isNumeric(std::string_view field) {
+        if (field.empty()) return false;
+        for (char c : field) {
+            if (c < '0' || c > '9') return false;
         }
+        return true;
+    }
 
-        // Parse outputs
-        if (index >= parts.size()) return false;
-        size_t outputCount = std::stoul(parts[index++]);
-        outputs.clear();
-        for (size_t i = 0; i < outputCount; i++) {
-            if (index + 2 >= parts.size()) return false;
-
-            TransactionOutput output;
-            output.address = parts[index++];
-            output.amount = std::stod(parts[index++]);
-
-            // Script is now hex encoded, or might be empty/last
-            if (index < parts.size()) {
-                std::string scriptHex = parts[index++];
-                output.script = safeDeserialize(scriptHex);
-            } else {
-                output.script = "";
-            }
-            outputs.push_back(output);
+private:
+    static bool isHex(std::string_view field) {
+        if (field.size() % 2 != 0) return false;
+        for (char c : field) {
+            if (hexValue(c) < 0) return false;
         }
+        return true;
+    }
 
-        if (isGoldBacked && index < parts.size()) {
-            popReference = parts[index++];
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    std::string_view rest;
+    bool exhausted;
+};
+
+bool Transaction::deserialize(const std::string& data, bool verifyHash) {
+    if (data.empty()) return false;
+    
+    // Fields are overwritten in place, so even a failed parse must not keep the old
+    // hash or the memoized verdicts about the old contents
+    invalidate();
+    FieldReader reader(data);
+    std::string_view field;
+    
+    uint64_t timestampIn = 0;
+    uint64_t nonceIn = 0;
+    uint64_t lockTimeIn = 0;
+    
+    if (!reader.nextString(txHash) ||
+        !reader.nextNumber(timestampIn) ||
+        !reader.nextString(prevTxHash) ||
+        !reader.nextNumber(referencedAmount) ||
+        !reader.nextString(senderAddress) ||
+        !reader.nextString(receiverAddress) ||
+        !reader.nextNumber(nonceIn) ||
+        !reader.nextNumber(fee) ||
+        !reader.nextEncoded(memo) ||
+        !reader.nextNumber(lockTimeIn)) {
+        return false;
+    }
+    timestamp = timestampIn;
+    nonce = static_cast<decltype(nonce)>(nonceIn);
+    lockTime = static_cast<decltype(lockTime)>(lockTimeIn);
+    
+    if (!reader.next(field)) return false;
+    isGoldBacked = (field == "1");
+    if (!reader.next(field)) return false;
+    isCoinbase = (field == "1");
+    
+    // Handle type field which was added to serialization
+    type = TransactionType::NORMAL;
+    if (reader.peek(field) && FieldReader::isNumeric(field)) {
+        int typeInt = 0;
+        if (!reader.nextNumber(typeInt)) return false;
+        type = static_cast<TransactionType>(typeInt);
+    }
+    
+    // Parse inputs
+    size_t inputCount = 0;
+    if (!reader.nextNumber(inputCount)) return false;
+    inputs.clear();
+    inputs.reserve(std::min<size_t>(inputCount, data.size() / 5));
+    for (size_t i = 0; i < inputCount; i++) {
+        TransactionInput input;
+        if (!reader.nextString(input.txHash) ||
+            !reader.nextNumber(input.outputIndex) ||
+            !reader.nextString(input.signature) ||
+            !reader.nextNumber(input.amount) ||
+            !reader.nextString(input.publicKey)) {
+            return false;
         }
+        inputs.push_back(std::move(input));
+    }
+    
+    // Parse outputs
+    size_t outputCount = 0;
+    if (!reader.nextNumber(outputCount)) return false;
+    outputs.clear();
+    outputs.reserve(std::min<size_t>(outputCount, data.size() / 3));
+    for (size_t i = 0; i < outputCount; i++) {
+        TransactionOutput output;
+        if (!reader.nextString(output.address) ||
+            !reader.nextNumber(output.amount)) {
+            return false;
+        }
+        // Script is hex encoded, or might be empty/last
+        if (!reader.nextEncoded(output.script)) {
+            output.script.clear();
+        }
+        output.classifyScript();
+        outputs.push_back(std::move(output));
+    }
+    
+    if (isGoldBacked) {
+        reader.nextString(popReference);
+    }
+    
+    // Integrity check, only when asked for; a record that fails it keeps its hash dirty
+    if (verifyHash && !hashMatches(txHash)) {
+        return false;
+    }
+    
+    hashDirty.store(false);
+    return true;
+}
+
+// Binary relay encoding: a version byte, then every field little-endian and
+// fixed-width, amounts as their IEEE-754 bits and strings length-prefixed. Unlike
+// serialize() it is exact for every field, including the ones the text form drops.
+static const uint8_t BINARY_ENCODING_VERSION = 1;
+static const uint8_t BINARY_FLAG_GOLD_BACKED = 0x01;
+static const uint8_t BINARY_FLAG_COINBASE = 0x02;
+
+static void putLE(std::string& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+static void putDouble(std::string& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putLE(out, bits, 8);
+}
 
-        // Recalculate hash to verify integrity
-        // Note: Hash calculation logic might need to align if it uses internal members that were populated
-        std::string calculatedHash = calculateHash();
-        if (calculatedHash != txHash) {
-             // Hash mismatch logging
+static void putBytes(std::string& out, const std::string& value) {
+    putLE(out, value.size(), 4);
+    out.append(value);
+}
+
+class BinaryReader {
+public:
+    explicit BinaryReader(std::string_view data) : rest(data) {}
+
+    bool le(uint64_t& value, size_t bytes) {
+        if (rest.size() < bytes) return false;
+        value = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(rest[i])) << (8 * i);
         }
+        rest.remove_prefix(bytes);
+        return true;
+    }
+
+    template <typename T>
+    bool integer(T& value, size_t bytes) {
+        uint64_t raw;
+        if (!le(raw, bytes)) return false;
+        value = static_cast<T>(raw);
+        return true;
+    }
+
+    bool real(double& value) {
+        uint64_t bits;
+        if (!le(bits, 8)) return false;
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
 
+    bool bytes(std::string& value) {
+        uint64_t length;
+        if (!le(length, 4) || length > rest.size()) return false;
+        value.assign(rest.data(), length);
+        rest.remove_prefix(length);
         return true;
-    } catch (const std::exception& e) {
+    }
+
+    size_t remaining() const { return rest.size(); }
+
+private:
+    std::string_view rest;
+};
+
+std::string Transaction::serializeBinary() const {
+    std::string out;
+    out.reserve(128 + inputs.size() * 256 + outputs.size() * 128);
+    
+    out.push_back(static_cast<char>(BINARY_ENCODING_VERSION));
+    putLE(out, timestamp, 8);
+    putBytes(out, prevTxHash);
+    putDouble(out, referencedAmount);
+    putBytes(out, senderAddress);
+    putBytes(out, receiverAddress);
+    putLE(out, nonce, 4);
+    putDouble(out, fee);
+    putBytes(out, memo);
+    putLE(out, lockTime, 4);
+    out.push_back(static_cast<char>((isGoldBacked ? BINARY_FLAG_GOLD_BACKED : 0) |
+                                    (isCoinbase ? BINARY_FLAG_COINBASE : 0)));
+    out.push_back(static_cast<char>(type));
+    putBytes(out, popReference);
+    putBytes(out, workReceiptHash);
+    putLE(out, blockHeight, 4);
+    
+    putLE(out, inputs.size(), 4);
+    for (const auto& input : inputs) {
+        putBytes(out, input.txHash);
+        putLE(out, input.outputIndex, 4);
+        putBytes(out, input.signature);
+        putDouble(out, input.amount);
+        putBytes(out, input.publicKey);
+    }
+    
+    putLE(out, outputs.size(), 4);
+    for (const auto& output : outputs) {
+        putBytes(out, output.address);
+        putDouble(out, output.amount);
+        putBytes(out, output.script);
+    }
+    return out;
+}
+
+// The hash is not carried: it is recomputed from the decoded fields, so a peer
+// cannot pair a transaction with someone else's txid.
+bool Transaction::deserializeBinary(std::string_view data) {
+    BinaryReader reader(data);
+    uint64_t version, flags, typeIn, inputCount, outputCount;
+    
+    if (!reader.le(version, 1) || version != BINARY_ENCODING_VERSION) return false;
+    
+    // Fields are overwritten in place, so even a failed decode must not keep the old hash
+    invalidate();
+    if (!reader.integer(timestamp, 8) ||
+        !reader.bytes(prevTxHash) ||
+        !reader.real(referencedAmount) ||
+        !reader.bytes(senderAddress) ||
+        !reader.bytes(receiverAddress) ||
+        !reader.integer(nonce, 4) ||
+        !reader.real(fee) ||
+        !reader.bytes(memo) ||
+        !reader.integer(lockTime, 4) ||
+        !reader.le(flags, 1) ||
+        !reader.le(typeIn, 1) ||
+        !reader.bytes(popReference) ||
+        !reader.bytes(workReceiptHash) ||
+        !reader.integer(blockHeight, 4)) {
         return false;
     }
+    isGoldBacked = (flags & BINARY_FLAG_GOLD_BACKED) != 0;
+    isCoinbase = (flags & BINARY_FLAG_COINBASE) != 0;
+    type = static_cast<TransactionType>(typeIn);
+    
+    // An input encodes to at least 24 bytes and an output to 16; checked before reserving
+    if (!reader.le(inputCount, 4) || inputCount > reader.remaining() / 24) return false;
+    inputs.clear();
+    inputs.reserve(inputCount);
+    for (uint64_t i = 0; i < inputCount; i++) {
+        TransactionInput input;
+        if (!reader.bytes(input.txHash) ||
+            !reader.integer(input.outputIndex, 4) ||
+            !reader.bytes(input.signature) ||
+            !reader.real(input.amount) ||
+            !reader.bytes(input.publicKey)) {
+            return false;
+        }
+        inputs.push_back(std::move(input));
+    }
+    
+    if (!reader.le(outputCount, 4) || outputCount > reader.remaining() / 16) return false;
+    outputs.clear();
+    outputs.reserve(outputCount);
+    for (uint64_t i = 0; i < outputCount; i++) {
+        TransactionOutput output;
+        if (!reader.bytes(output.address) ||
+            !reader.real(output.amount) ||
+            !reader.bytes(output.script)) {
+            return false;
+        }
+        output.classifyScript();
+        outputs.push_back(std::move(output));
+    }
+    return reader.remaining() == 0;
 }
 
 std::vector<std::string> Transaction::getInputHashes() const {
     std::vector<std::string> hashes;
+    hashes.reserve(inputs.size());
     for (const auto& input : inputs) {
         hashes.push_back(input.txHash);
     }
@@ -464,22 +942,40 @@ bool Transaction::hasValidPrevReference() const {
 // Add/modify transaction data
 void Transaction::addInput(const TransactionInput& input) {
     inputs.push_back(input);
-    txHash = calculateHash(); // Recalculate hash
+    invalidate();
 }
 
 void Transaction::addOutput(const TransactionOutput& output) {
     outputs.push_back(output);
-    txHash = calculateHash(); // Recalculate hash
+    outputs.back().classifyScript();
+    invalidate();
+}
+
+void Transaction::setInputs(std::vector<TransactionInput>&& inputsIn) {
+    inputs = std::move(inputsIn);
+    invalidate();
+}
+
+void Transaction::setOutputs(std::vector<TransactionOutput>&& outputsIn) {
+    outputs = std::move(outputsIn);
+    for (auto& output : outputs) {
+        output.classifyScript();
+    }
+    invalidate();
 }
 
 void Transaction::clearInputs() {
     inputs.clear();
-    txHash = calculateHash();
+    invalidate();
 }
 
 void Transaction::clearOutputs() {
     outputs.clear();
-    txHash = calculateHash();
+    invalidate();
+}
+
+void TransactionOutput::classifyScript() {
+    scriptTemplate = ScriptTemplate::classify(script);
 }
 
 // Validation function: verify that the scriptSig in the inputs matches the scriptPubKey of the UTXOs being spent
@@ -487,33 +983,23 @@ void Transaction::clearOutputs() {
 bool Transaction::verifyScript(const std::string& signature, const std::string& publicKey, const std::string& scriptPubKey) {
     // This is a simplified P2PKH script verification
     // scriptPubKey format: "OP_DUP OP_HASH160 <address> OP_EQUALVERIFY OP_CHECKSIG"
+    TransactionOutput spent;
+    spent.script = scriptPubKey;
+    spent.classifyScript();
+    return verifyScript(signature, publicKey, spent);
+}
 
-    // 1. Extract address from scriptPubKey
-    std::string address;
-    std::string prefix = "OP_DUP OP_HASH160 ";
-    std::string suffix = " OP_EQUALVERIFY OP_CHECKSIG";
-
-    size_t startPos = scriptPubKey.find(prefix);
-    size_t endPos = scriptPubKey.find(suffix);
-
-    if (startPos != std::string::npos && endPos != std::string::npos && endPos > startPos) {
-        address = scriptPubKey.substr(startPos + prefix.length(), endPos - (startPos + prefix.length()));
-    } else {
-        // If script format doesn't match standard P2PKH, fall back to checking if script IS the address (legacy support)
-        if (scriptPubKey.find("OP_") == std::string::npos) {
-            address = scriptPubKey;
-        } else {
-            return false; // Unknown script format
-        }
+bool Transaction::verifyScript(const std::string& signature, const std::string& publicKey, const TransactionOutput& spent) {
+    // 1. The script was classified when the output was built or decoded
+    const ScriptTemplate& script = spent.scriptTemplate;
+    if (script.type == ScriptTemplate::Type::UNKNOWN) {
+        return false; // Unknown script format
     }
 
     // 2. Verify that publicKey generates this address
-    // Note: We need to know if it's testnet or mainnet.
-    // Usually address prefix determines this.
-    bool isTestnet = (address.length() >= 4 && address.substr(0, 4) == "tGXC");
-    std::string derivedAddress = Crypto::generateAddress(publicKey, isTestnet);
-
-    if (derivedAddress != address) {
+    // The network comes from the address prefix, decoded with the rest of the address.
+    // Derivations are cached, so repeat payers cost a lookup and a byte compare.
+    if (!AddressCache::matches(publicKey, script.address)) {
         return false;
     }
 
@@ -0,0 +1,93 @@
+#include "../include/TransactionBuilder.h"
+
+TransactionBuilder::TransactionBuilder() : hasHash(false) {
+}
+
+TransactionBuilder& TransactionBuilder::reserve(size_t inputCount, size_t outputCount) {
+    inputs.reserve(inputCount);
+    outputs.reserve(outputCount);
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::addInput(TransactionInput input) {
+    inputs.push_back(std::move(input));
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::addOutput(TransactionOutput output) {
+    outputs.push_back(std::move(output));
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::setInputs(std::vector<TransactionInput> inputsIn) {
+    inputs = std::move(inputsIn);
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::setOutputs(std::vector<TransactionOutput> outputsIn) {
+    outputs = std::move(outputsIn);
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::setHash(std::string hashIn) {
+    hash = std::move(hashIn);
+    hasHash = true;
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::setSenderAddress(std::string address) {
+    tx.setSenderAddress(std::move(address));
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::setReceiverAddress(std::string address) {
+    tx.setReceiverAddress(std::move(address));
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::setFee(double fee) {
+    tx.setFee(fee);
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::setTimestamp(uint64_t timestamp) {
+    tx.setTimestamp(timestamp);
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::setNonce(uint64_t nonce) {
+    tx.setNonce(nonce);
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::setCoinbase(bool coinbase) {
+    tx.setCoinbaseTransaction(coinbase);
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::setPrevTxHash(std::string prevTxHash) {
+    tx.setPrevTxHash(std::move(prevTxHash));
+    return *this;
+}
+
+TransactionBuilder& TransactionBuilder::setReferencedAmount(double amount) {
+    tx.setReferencedAmount(amount);
+    return *this;
+}
+
+Transaction TransactionBuilder::build() {
+    tx.setInputs(std::move(inputs));
+    tx.setOutputs(std::move(outputs));
+    if (hasHash) {
+        tx.setHash(std::move(hash));
+    }
+    
+    Transaction built = std::move(tx);
+    
+    tx = Transaction();
+    inputs.clear();
+    outputs.clear();
+    hash.clear();
+    hasHash = false;
+    return built;
+}
@@ -0,0 +1,76 @@
+#include "../include/UtxoSetHash.h"
+#include "../include/HashUtils.h"
+#include "../include/Utils.h"
+
+UtxoSetHash::UtxoSetHash() {
+    clear();
+}
+
+void UtxoSetHash::expand(const std::string& key, const std::string& value, std::array<uint16_t, LANES>& out) {
+    // Expand the element into LANES * 2 bytes with counter-mode keccak
+    std::string element = std::to_string(key.size()) + ":" + key + value;
+    size_t lane = 0;
+    for (uint32_t counter = 0; lane < LANES; counter++) {
+        std::vector<uint8_t> block = Utils::fromHex(keccak256(element + ":" + std::to_string(counter)));
+        for (size_t i = 0; i + 1 < block.size() && lane < LANES; i += 2) {
+            out[lane++] = static_cast<uint16_t>(block[i] | (block[i + 1] << 8));
+        }
+    }
+}
+
+void UtxoSetHash::add(const std::string& key, const std::string& value) {
+    std::array<uint16_t, LANES> element;
+    expand(key, value, element);
+    for (size_t i = 0; i < LANES; i++) {
+        lanes[i] = static_cast<uint16_t>(lanes[i] + element[i]);
+    }
+}
+
+void UtxoSetHash::remove(const std::string& key, const std::string& value) {
+    std::array<uint16_t, LANES> element;
+    expand(key, value, element);
+    for (size_t i = 0; i < LANES; i++) {
+        lanes[i] = static_cast<uint16_t>(lanes[i] - element[i]);
+    }
+}
+
+void UtxoSetHash::combine(const UtxoSetHash& other) {
+    for (size_t i = 0; i < LANES; i++) {
+        lanes[i] = static_cast<uint16_t>(lanes[i] + other.lanes[i]);
+    }
+}
+
+void UtxoSetHash::clear() {
+    lanes.fill(0);
+}
+
+std::string UtxoSetHash::digest() const {
+    std::string state;
+    state.reserve(LANES * 2);
+    for (uint16_t lane : lanes) {
+        state.push_back(static_cast<char>(lane & 0xff));
+        state.push_back(static_cast<char>(lane >> 8));
+    }
+    return keccak256(state);
+}
+
+std::string UtxoSetHash::serialize() const {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(LANES * 2);
+    for (uint16_t lane : lanes) {
+        bytes.push_back(static_cast<uint8_t>(lane & 0xff));
+        bytes.push_back(static_cast<uint8_t>(lane >> 8));
+    }
+    return Utils::toHex(bytes);
+}
+
+bool UtxoSetHash::deserialize(const std::string& hex) {
+    if (hex.size() != LANES * 4 || !Utils::isValidHex(hex)) {
+        return false;
+    }
+    std::vector<uint8_t> bytes = Utils::fromHex(hex);
+    for (size_t i = 0; i < LANES; i++) {
+        lanes[i] = static_cast<uint16_t>(bytes[2 * i] | (bytes[2 * i + 1] << 8));
+    }
+    return true;
+}
@@ -0,0 +1,344 @@
+#include "../include/ValidatorMetricsLog.h"
+#include "../include/Logger.h"
+#include <leveldb/db.h>
+#include <leveldb/write_batch.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+using json = nlohmann::json;
+
+// Every address with deltas is folded at least this often
+static const auto FOLD_INTERVAL = std::chrono::seconds(30);
+
+// Zero counters are omitted; most blocks change one or two of them
+static std::string deltaToJson(const ValidatorDelta& delta) {
+    json j = json::object();
+    if (delta.blocksProduced) j["blocks_produced"] = delta.blocksProduced;
+    if (delta.missedBlocks) j["missed_blocks"] = delta.missedBlocks;
+    if (delta.totalRewards != 0.0) j["total_rewards"] = delta.totalRewards;
+    if (delta.pendingRewards != 0.0) j["pending_rewards"] = delta.pendingRewards;
+    return j.dump();
+}
+
+static ValidatorDelta deltaFromJson(const std::string& data) {
+    json j = json::parse(data);
+    ValidatorDelta delta;
+    delta.blocksProduced = j.value("blocks_produced", int64_t(0));
+    delta.missedBlocks = j.value("missed_blocks", int64_t(0));
+    delta.totalRewards = j.value("total_rewards", 0.0);
+    delta.pendingRewards = j.value("pending_rewards", 0.0);
+    return delta;
+}
+
+ValidatorMetricsLog::ValidatorMetricsLog(leveldb::DB* db, const leveldb::WriteOptions& writeOptions,
+                                         const std::string& basePrefix, const std::string& deltaPrefix)
+    : db(db), writeOptions(writeOptions), basePrefix(basePrefix), deltaPrefix(deltaPrefix),
+      running(false), foldRequested(false), nextSequence(0), foldThreshold(256),
+      deltasAppended(0), deltasFolded(0), recordsFolded(0) {
+}
+
+ValidatorMetricsLog::~ValidatorMetricsLog() {
+    stop();
+}
+
+std::string ValidatorMetricsLog::deltaKey(const std::string& address, uint64_t sequence) const {
+    // Zero-padded so an address's deltas iterate in append order
+    std::string digits = std::to_string(sequence);
+    std::string key;
+    key.reserve(deltaPrefix.size() + address.size() + 21);
+    key.append(deltaPrefix);
+    key.append(address);
+    key.push_back(':');
+    key.append(20 - digits.size(), '0');
+    key.append(digits);
+    return key;
+}
+
+bool ValidatorMetricsLog::load() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingByAddress.clear();
+    nextSequence = 0;
+    
+    try {
+        std::unique_ptr<leveldb::Iterator> it(db->NewIterator(leveldb::ReadOptions()));
+        for (it->Seek(deltaPrefix); it->Valid() && it->key().starts_with(deltaPrefix); it->Next()) {
+            std::string key = it->key().ToString();
+            size_t separator = key.rfind(':');
+            if (separator == std::string::npos || separator < deltaPrefix.size()) continue;
+            
+            std::string address = key.substr(deltaPrefix.size(), separator - deltaPrefix.size());
+            uint64_t sequence = std::stoull(key.substr(separator + 1));
+            ValidatorDelta delta;
+            try {
+                delta = deltaFromJson(it->value().ToString());
+            } catch (const std::exception&) {
+                LOG_DATABASE(LogLevel::WARNING, "Skipping unreadable validator delta " + key);
+                continue;
+            }
+            
+            Pending& entry = pendingByAddress[address];
+            entry.sum += delta;
+            entry.sequences.push_back(sequence);
+            nextSequence = std::max(nextSequence, sequence + 1);
+        }
+        
+        // Deltas whose validator has no record (written before append() checked for
+        // one) can never be folded or read; drop them instead of retrying forever
+        leveldb::WriteBatch orphans;
+        size_t orphanCount = 0;
+        std::string record;
+        for (auto entry = pendingByAddress.begin(); entry != pendingByAddress.end();) {
+            if (db->Get(leveldb::ReadOptions(), basePrefix + entry->first, &record).ok()) {
+                ++entry;
+                continue;
+            }
+            for (uint64_t sequence : entry->second.sequences) {
+                orphans.Delete(deltaKey(entry->first, sequence));
+            }
+            orphanCount += entry->second.sequences.size();
+            entry = pendingByAddress.erase(entry);
+        }
+        if (orphanCount > 0) {
+            if (!db->Write(writeOptions, &orphans).ok()) {
+                LOG_DATABASE(LogLevel::ERROR, "Failed to drop orphaned validator deltas");
+                return false;
+            }
+            LOG_DATABASE(LogLevel::WARNING, "Dropped " + std::to_string(orphanCount) +
+                         " validator deltas with no stored validator");
+        }
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Failed to load validator deltas: " + std::string(e.what()));
+        return false;
+    }
+    
+    if (!pendingByAddress.empty()) {
+        LOG_DATABASE(LogLevel::INFO, "Loaded unfolded deltas for " + std::to_string(pendingByAddress.size()) + " validators");
+    }
+    return true;
+}
+
+void ValidatorMetricsLog::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) return;
+    running = true;
+    worker = std::thread(&ValidatorMetricsLog::run, this);
+}
+
+void ValidatorMetricsLog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        running = false;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool ValidatorMetricsLog::append(const std::vector<std::pair<std::string, ValidatorDelta>>& deltas) {
+    if (deltas.empty()) return true;
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    // A delta can only ever be folded into a stored record, so refuse the whole block
+    // rather than leave deltas that no read sees and no fold can apply. An address
+    // with pending deltas already has one: remove() drops the deltas with the record.
+    std::string record;
+    for (const auto& delta : deltas) {
+        if (pendingByAddress.count(delta.first)) continue;
+        if (!db->Get(leveldb::ReadOptions(), basePrefix + delta.first, &record).ok()) {
+            LOG_DATABASE(LogLevel::ERROR, "Refusing validator deltas: no stored validator " + delta.first);
+            return false;
+        }
+    }
+    
+    leveldb::WriteBatch batch;
+    uint64_t sequence = nextSequence;
+    for (const auto& delta : deltas) {
+        batch.Put(deltaKey(delta.first, sequence++), deltaToJson(delta.second));
+    }
+    
+    leveldb::Status status = db->Write(writeOptions, &batch);
+    if (!status.ok()) {
+        LOG_DATABASE(LogLevel::ERROR, "Failed to append validator deltas: " + status.ToString());
+        return false;
+    }
+    
+    bool foldDue = false;
+    for (const auto& delta : deltas) {
+        Pending& entry = pendingByAddress[delta.first];
+        entry.sum += delta.second;
+        entry.sequences.push_back(nextSequence++);
+        foldDue |= entry.sequences.size() >= foldThreshold;
+    }
+    deltasAppended += deltas.size();
+    
+    if (foldDue) {
+        foldRequested = true;
+        wakeup.notify_one();
+    }
+    return true;
+}
+
+bool ValidatorMetricsLog::read(const std::string& address, std::string& record, ValidatorDelta& pendingDelta) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!db->Get(leveldb::ReadOptions(), basePrefix + address, &record).ok()) {
+        return false;
+    }
+    auto found = pendingByAddress.find(address);
+    pendingDelta = found != pendingByAddress.end() ? found->second.sum : ValidatorDelta();
+    return true;
+}
+
+ValidatorDelta ValidatorMetricsLog::pending(const std::string& address) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = pendingByAddress.find(address);
+    return found != pendingByAddress.end() ? found->second.sum : ValidatorDelta();
+}
+
+bool ValidatorMetricsLog::replace(const std::string& address, const std::string& record) {
+    std::lock_guard<std::mutex> lock(mutex);
+    leveldb::WriteBatch batch;
+    batch.Put(basePrefix + address, record);
+    
+    auto found = pendingByAddress.find(address);
+    if (found != pendingByAddress.end()) {
+        for (uint64_t sequence : found->second.sequences) {
+            batch.Delete(deltaKey(address, sequence));
+        }
+    }
+    
+    if (!db->Write(writeOptions, &batch).ok()) {
+        return false;
+    }
+    if (found != pendingByAddress.end()) {
+        pendingByAddress.erase(found);
+    }
+    return true;
+}
+
+bool ValidatorMetricsLog::remove(const std::string& address) {
+    std::lock_guard<std::mutex> lock(mutex);
+    leveldb::WriteBatch batch;
+    batch.Delete(basePrefix + address);
+    
+    auto found = pendingByAddress.find(address);
+    if (found != pendingByAddress.end()) {
+        for (uint64_t sequence : found->second.sequences) {
+            batch.Delete(deltaKey(address, sequence));
+        }
+    }
+    
+    if (!db->Write(writeOptions, &batch).ok()) {
+        return false;
+    }
+    if (found != pendingByAddress.end()) {
+        pendingByAddress.erase(found);
+    }
+    return true;
+}
+
+// Called with the mutex held
+bool ValidatorMetricsLog::fold(const std::string& address) {
+    auto found = pendingByAddress.find(address);
+    if (found == pendingByAddress.end()) return true;
+    
+    std::string data;
+    if (!db->Get(leveldb::ReadOptions(), basePrefix + address, &data).ok()) {
+        return false;
+    }
+    
+    try {
+        const ValidatorDelta& sum = found->second.sum;
+        json record = json::parse(data);
+        record["blocks_produced"] = record.value("blocks_produced", int64_t(0)) + sum.blocksProduced;
+        record["missed_blocks"] = record.value("missed_blocks", int64_t(0)) + sum.missedBlocks;
+        record["total_rewards"] = record.value("total_rewards", 0.0) + sum.totalRewards;
+        record["pending_rewards"] = record.value("pending_rewards", 0.0) + sum.pendingRewards;
+        
+        // Base record and delta deletions land atomically, so a crash never double counts
+        leveldb::WriteBatch batch;
+        batch.Put(basePrefix + address, record.dump());
+        for (uint64_t sequence : found->second.sequences) {
+            batch.Delete(deltaKey(address, sequence));
+        }
+        if (!db->Write(writeOptions, &batch).ok()) {
+            return false;
+        }
+    } catch (const std::exception& e) {
+        LOG_DATABASE(LogLevel::ERROR, "Failed to fold deltas for validator " + address + ": " + std::string(e.what()));
+        return false;
+    }
+    
+    deltasFolded += found->second.sequences.size();
+    recordsFolded++;
+    pendingByAddress.erase(found);
+    return true;
+}
+
+bool ValidatorMetricsLog::foldAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> addresses;
+    addresses.reserve(pendingByAddress.size());
+    for (const auto& entry : pendingByAddress) {
+        addresses.push_back(entry.first);
+    }
+    
+    bool ok = true;
+    for (const auto& address : addresses) {
+        ok &= fold(address);
+    }
+    return ok;
+}
+
+void ValidatorMetricsLog::setFoldThreshold(size_t deltas) {
+    std::lock_guard<std::mutex> lock(mutex);
+    foldThreshold = std::max<size_t>(1, deltas);
+}
+
+ValidatorMetricsLog::Stats ValidatorMetricsLog::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats stats;
+    stats.deltasAppended = deltasAppended;
+    stats.deltasFolded = deltasFolded;
+    stats.recordsFolded = recordsFolded;
+    stats.pendingValidators = pendingByAddress.size();
+    for (const auto& entry : pendingByAddress) {
+        stats.pendingDeltas += entry.second.sequences.size();
+    }
+    return stats;
+}
+
+void ValidatorMetricsLog::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto lastFullFold = std::chrono::steady_clock::now();
+    
+    while (running) {
+        wakeup.wait_for(lock, FOLD_INTERVAL, [this] { return !running || foldRequested; });
+        if (!running) break;
+        foldRequested = false;
+        
+        // Busy validators on every wakeup; everything else once per interval
+        bool fullFold = std::chrono::steady_clock::now() - lastFullFold >= FOLD_INTERVAL;
+        std::vector<std::string> addresses;
+        for (const auto& entry : pendingByAddress) {
+            if (fullFold || entry.second.sequences.size() >= foldThreshold) {
+                addresses.push_back(entry.first);
+            }
+        }
+        if (fullFold) {
+            lastFullFold = std::chrono::steady_clock::now();
+        }
+        
+        // Release the lock between validators so appends and reads are not stalled
+        for (const auto& address : addresses) {
+            fold(address);
+            lock.unlock();
+            lock.lock();
+            if (!running) break;
+        }
+    }
+}
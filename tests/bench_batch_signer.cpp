@@ -0,0 +1,111 @@
+// Payout signing benchmark: BatchSigner against calling signInputs() on each
+// transaction, with the node's real Crypto. Every batch signature must verify under
+// Crypto::verifySignature and every signed transaction must rehash.
+#include "../include/BatchSigner.h"
+#include "../include/Crypto.h"
+#include "../include/HashUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static std::vector<Transaction> makePayouts(size_t count) {
+    std::vector<Transaction> payouts;
+    payouts.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::vector<TransactionInput> inputs(1 + i % 3);
+        for (size_t j = 0; j < inputs.size(); j++) {
+            inputs[j].txHash = keccak256("pool reward" + std::to_string(i));
+            inputs[j].outputIndex = static_cast<uint32_t>(j);
+            inputs[j].amount = 2.5;
+        }
+        std::vector<TransactionOutput> outputs(1);
+        outputs[0].address = "GXC" + keccak256("miner" + std::to_string(i)).substr(0, 34);
+        outputs[0].amount = 2.5 * inputs.size() - 0.001;
+        payouts.emplace_back(std::move(inputs), std::move(outputs), keccak256("pool reward" + std::to_string(i)));
+    }
+    return payouts;
+}
+
+static bool allValid(const std::vector<Transaction>& payouts, const std::vector<std::string>& publicKeys) {
+    for (size_t i = 0; i < payouts.size(); i++) {
+        const Transaction& tx = payouts[i];
+        if (tx.getHash() != tx.calculateHash()) {
+            std::cerr << "FAIL: transaction " << i << " kept its unsigned hash\n";
+            return false;
+        }
+        for (const auto& input : tx.getInputs()) {
+            if (input.publicKey != publicKeys[i] ||
+                !Crypto::verifySignature(Transaction::signatureMessage(input), input.signature, input.publicKey)) {
+                std::cerr << "FAIL: transaction " << i << " has an input that does not verify\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    const size_t payoutCount = 2000;
+    const size_t keyCount = 8;
+
+    // A pool pays out from a handful of hot-wallet keys
+    std::vector<std::string> keys(payoutCount);
+    std::vector<std::string> publicKeys(payoutCount);
+    for (size_t i = 0; i < payoutCount; i++) {
+        keys[i] = keccak256("hot wallet " + std::to_string(i % keyCount));
+        publicKeys[i] = Crypto::derivePublicKey(keys[i]);
+    }
+
+    const std::vector<Transaction> blank = makePayouts(payoutCount);
+    size_t inputCount = 0;
+    for (const auto& tx : blank) {
+        tx.getHash();
+        inputCount += tx.getInputs().size();
+    }
+
+    // Baseline: signInputs() per transaction, deriving the public key each time
+    std::vector<Transaction> serial = blank;
+    auto serialStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < serial.size(); i++) {
+        serial[i].signInputs(keys[i]);
+    }
+    double serialSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - serialStart).count();
+    if (!allValid(serial, publicKeys)) return 1;
+
+    std::cout << "hardware threads " << std::thread::hardware_concurrency() << ", " << inputCount
+              << " inputs over " << keyCount << " keys\n";
+    std::cout << "signInputs per tx: " << inputCount / serialSeconds << " sig/s\n";
+
+    std::vector<size_t> poolSizes = {1, std::max<size_t>(1, std::thread::hardware_concurrency())};
+    poolSizes.erase(std::unique(poolSizes.begin(), poolSizes.end()), poolSizes.end());
+    for (size_t threads : poolSizes) {
+        ThreadPool pool(threads);
+        std::vector<Transaction> batch = blank;
+        std::vector<Transaction*> pointers;
+        for (auto& tx : batch) {
+            pointers.push_back(&tx);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        size_t signedCount = BatchSigner(pool).sign(pointers, keys);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (signedCount != inputCount || !allValid(batch, publicKeys)) {
+            std::cerr << "FAIL: " << threads << "-thread batch\n";
+            return 1;
+        }
+        std::cout << "BatchSigner, " << threads << " thread(s): " << inputCount / seconds << " sig/s ("
+                  << serialSeconds / seconds << "x)\n";
+    }
+
+    // Mismatched arguments sign nothing
+    std::vector<Transaction> untouched = blank;
+    std::vector<Transaction*> pointers = {&untouched[0], &untouched[1]};
+    if (BatchSigner().sign(pointers, {keys[0]}) != 0 || !untouched[0].getInputs()[0].signature.empty()) {
+        std::cerr << "FAIL: mismatched key list was used\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Block amount checks: BlockAmountView against the per-transaction loops over
+// getTotalInputAmount()/getTotalOutputAmount(). Verdicts must agree on every
+// transaction, including the edges of the 1e-8 tolerance, zero and NaN outputs and
+// sums that overflow to infinity, before anything is timed.
+#include "../include/BlockAmounts.h"
+#include "../include/HashUtils.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+// The amount rules of verifyTransaction(), one transaction at a time
+static bool scalarValid(const Transaction& tx) {
+    for (const auto& output : tx.getOutputs()) {
+        if (!(output.amount > 0)) return false;
+    }
+    if (tx.isCoinbaseTransaction()) return true;
+    return std::abs(tx.getTotalInputAmount() - (tx.getTotalOutputAmount() + tx.getFee())) < 0.00000001;
+}
+
+static Transaction makeTransaction(std::mt19937_64& rng, size_t inputCount, size_t outputCount, double fee) {
+    std::uniform_real_distribution<double> amount(0.00000001, 500.0);
+    std::vector<TransactionInput> inputs(inputCount);
+    std::vector<TransactionOutput> outputs(outputCount);
+    double outputTotal = 0.0;
+    for (auto& output : outputs) {
+        output.address = "GXCpayee";
+        output.amount = amount(rng);
+        outputTotal += output.amount;
+    }
+    // Inputs split outputs + fee, the last one taking the remainder
+    double remaining = outputTotal + fee;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        inputs[i].txHash = keccak256("funding" + std::to_string(rng()));
+        inputs[i].amount = i + 1 < inputs.size() ? remaining / 2 : remaining;
+        remaining -= inputs[i].amount;
+    }
+    Transaction tx(std::move(inputs), std::move(outputs), keccak256("funding"));
+    tx.setFee(fee);
+    return tx;
+}
+
+static std::vector<Transaction> makeBlock(std::mt19937_64& rng, size_t count) {
+    std::vector<Transaction> block;
+    block.reserve(count);
+    block.push_back(Transaction("GXCminer", 50.0));
+    while (block.size() < count) {
+        block.push_back(makeTransaction(rng, 1 + rng() % 8, 1 + rng() % 4, 0.001));
+    }
+    return block;
+}
+
+static std::vector<Transaction> makeEdgeCases(std::mt19937_64& rng) {
+    std::vector<Transaction> cases;
+    const double huge = std::numeric_limits<double>::max();
+
+    // Valid under the tolerance, off by just under and just over it
+    for (double offset : {0.0, 0.000000005, -0.000000009, 0.000000011, -0.00000002, 1.0}) {
+        Transaction tx = makeTransaction(rng, 2, 2, 0.001);
+        tx.setFee(0.001 + offset);
+        cases.push_back(tx);
+    }
+
+    // 1.000000005 in against 0.5000000025 + 0.5000000025 out
+    std::vector<TransactionInput> inputs(1);
+    inputs[0].txHash = keccak256("edge");
+    inputs[0].amount = 1.000000005;
+    std::vector<TransactionOutput> outputs(2);
+    outputs[0].amount = outputs[1].amount = 0.5000000025;
+    cases.emplace_back(std::move(inputs), std::move(outputs), keccak256("edge"));
+
+    for (double bad : {0.0, -1.0, -0.0, std::nan(""), huge}) {
+        Transaction tx = makeTransaction(rng, 1, 3, 0.0);
+        std::vector<TransactionOutput> changed = tx.getOutputs();
+        changed[1].amount = bad;
+        tx.setOutputs(std::move(changed));
+        cases.push_back(tx);
+    }
+
+    // Sums that overflow to infinity on both sides
+    Transaction overflow = makeTransaction(rng, 2, 2, 0.0);
+    std::vector<TransactionInput> bigInputs = overflow.getInputs();
+    std::vector<TransactionOutput> bigOutputs = overflow.getOutputs();
+    bigInputs[0].amount = bigInputs[1].amount = huge;
+    bigOutputs[0].amount = bigOutputs[1].amount = huge;
+    overflow.setInputs(std::move(bigInputs));
+    overflow.setOutputs(std::move(bigOutputs));
+    cases.push_back(overflow);
+
+    Transaction zeroCoinbase("GXCminer", 0.0);
+    cases.push_back(zeroCoinbase);
+    return cases;
+}
+
+int main() {
+    std::mt19937_64 rng(42);
+
+    // Equivalence on random blocks and on every edge case in every lane position
+    std::vector<Transaction> edges = makeEdgeCases(rng);
+    for (size_t shift = 0; shift < BlockAmountView::LANES; shift++) {
+        std::vector<Transaction> block = makeBlock(rng, 1 + shift);
+        block.insert(block.end(), edges.begin(), edges.end());
+        std::vector<Transaction> random = makeBlock(rng, 37);
+        block.insert(block.end(), random.begin(), random.end());
+
+        BlockAmountView view;
+        view.build(block);
+        size_t firstInvalid = block.size();
+        for (size_t t = 0; t < block.size(); t++) {
+            bool expected = scalarValid(block[t]);
+            if (view.transactionValid(t) != expected) {
+                std::cerr << "FAIL: verdicts differ for transaction " << t << " (shift " << shift << ")\n";
+                return 1;
+            }
+            if (!expected && firstInvalid == block.size()) firstInvalid = t;
+        }
+        BlockAmountView::CheckResult result = view.check();
+        if (result.valid || result.txIndex != firstInvalid) {
+            std::cerr << "FAIL: check() did not report the first invalid transaction\n";
+            return 1;
+        }
+    }
+
+    BlockAmountView empty;
+    empty.build({});
+    if (!empty.check().valid) {
+        std::cerr << "FAIL: empty block rejected\n";
+        return 1;
+    }
+
+    // 4000-transaction valid block
+    std::vector<Transaction> block = makeBlock(rng, 4000);
+    const size_t rounds = 200;
+
+    auto start = std::chrono::steady_clock::now();
+    size_t scalarPassed = 0;
+    for (size_t round = 0; round < rounds; round++) {
+        for (const auto& tx : block) {
+            scalarPassed += scalarValid(tx) ? 1 : 0;
+        }
+    }
+    double scalarSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    BlockAmountView view;
+    start = std::chrono::steady_clock::now();
+    size_t viewPassed = 0;
+    for (size_t round = 0; round < rounds; round++) {
+        view.build(block);
+        viewPassed += view.check().valid ? block.size() : 0;
+    }
+    double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+        viewPassed += view.check().valid ? block.size() : 0;
+    }
+    double checkSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (scalarPassed != block.size() * rounds || viewPassed != 2 * block.size() * rounds) {
+        std::cerr << "FAIL: benchmark block did not validate\n";
+        return 1;
+    }
+
+    auto perBlock = [&](double seconds) { return seconds / rounds * 1e6; };
+    std::cout << "4000-tx block, per block:\n"
+              << "per-transaction loops:     " << perBlock(scalarSeconds) << " us\n"
+              << "BlockAmountView build+check " << perBlock(buildSeconds) << " us\n"
+              << "BlockAmountView check only: " << perBlock(checkSeconds) << " us ("
+              << scalarSeconds / checkSeconds << "x)\n";
+    return 0;
+}
@@ -0,0 +1,150 @@
+// Block assembly benchmark: Mempool::selectForBlock on the ancestor fee rate index
+// against re-sorting the whole pool by fee rate for every template. Also checks that
+// entry fees come from the resolved coins rather than the declared fee.
+#include "../include/Mempool.h"
+#include "../include/HashUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <vector>
+
+struct Coins {
+    std::map<std::pair<std::string, uint32_t>, TransactionOutput> confirmed;
+
+    Mempool::CoinLookup lookup() const {
+        return [this](const std::string& txHash, uint32_t outputIndex, TransactionOutput& output) {
+            auto found = confirmed.find({txHash, outputIndex});
+            if (found == confirmed.end()) return false;
+            output = found->second;
+            return true;
+        };
+    }
+};
+
+static Transaction makeSpend(const std::string& prevHash, uint32_t prevIndex, double value, double fee, size_t seed) {
+    std::vector<TransactionInput> inputs(1);
+    inputs[0].txHash = prevHash;
+    inputs[0].outputIndex = prevIndex;
+    inputs[0].amount = value;
+    inputs[0].signature = std::string(142, 'a' + seed % 26);
+    inputs[0].publicKey = std::string(66, '0' + seed % 10);
+
+    std::vector<TransactionOutput> outputs(2);
+    outputs[0].address = "GXC" + keccak256("to" + std::to_string(seed)).substr(0, 34);
+    outputs[0].amount = (value - fee) / 2;
+    outputs[1].address = "GXC" + keccak256("change" + std::to_string(seed)).substr(0, 34);
+    outputs[1].amount = value - fee - outputs[0].amount;
+
+    Transaction tx(std::move(inputs), std::move(outputs), prevHash);
+    tx.setFee(fee);
+    return tx;
+}
+
+int main() {
+    const size_t rootCount = 20000;
+    const size_t chainLength = 3;
+    const size_t templates = 50;
+    const size_t maxBytes = 1000000;
+    const size_t maxCount = 4000;
+
+    Coins coins;
+    std::vector<Transaction> pending;
+    for (size_t i = 0; i < rootCount; i++) {
+        std::string funding = keccak256("funding" + std::to_string(i));
+        coins.confirmed[{funding, 0}] = TransactionOutput{"GXCfunding", 100.0, ""};
+
+        // Short chains, so child-pays-for-parent packages are part of the load
+        std::string prevHash = funding;
+        double value = 100.0;
+        for (size_t depth = 0; depth < chainLength; depth++) {
+            double fee = 0.0001 * static_cast<double>(1 + (i * 7 + depth * 13) % 97);
+            Transaction tx = makeSpend(prevHash, depth == 0 ? 0 : 1, value, fee, i * chainLength + depth);
+            prevHash = tx.getHash();
+            value = tx.getOutputs()[1].amount;
+            pending.push_back(std::move(tx));
+        }
+    }
+
+    Mempool mempool(Mempool::DEFAULT_MAX_MEMORY);
+    auto addStart = std::chrono::steady_clock::now();
+    for (const auto& tx : pending) {
+        if (mempool.add(tx, coins.lookup()) != Mempool::AddResult::ADDED) {
+            std::cerr << "FAIL: could not add " << tx.getHash() << "\n";
+            return 1;
+        }
+    }
+    double addSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - addStart).count();
+
+    // A declared fee that the inputs do not pay for is ignored
+    std::string overclaimFunding = keccak256("overclaim");
+    coins.confirmed[{overclaimFunding, 0}] = TransactionOutput{"GXCfunding", 1.0, ""};
+    Transaction overclaim = makeSpend(overclaimFunding, 0, 1.0, 0.0, 999999);
+    overclaim.setFee(50.0);
+    if (mempool.add(overclaim, coins.lookup()) != Mempool::AddResult::ADDED) {
+        std::cerr << "FAIL: could not add the zero-fee transaction\n";
+        return 1;
+    }
+    std::vector<Transaction> top = mempool.selectForBlock(maxBytes, 1);
+    if (top.empty() || top[0].getHash() == overclaim.getHash()) {
+        std::cerr << "FAIL: declared fee was trusted over the resolved input amounts\n";
+        return 1;
+    }
+
+    // Outputs worth more than the inputs, and inputs nobody knows, are refused
+    std::string thinFunding = keccak256("thin");
+    coins.confirmed[{thinFunding, 0}] = TransactionOutput{"GXCfunding", 0.5, ""};
+    if (mempool.add(makeSpend(thinFunding, 0, 1.0, 0.0, 1000001), coins.lookup()) != Mempool::AddResult::INVALID) {
+        std::cerr << "FAIL: accepted outputs exceeding inputs\n";
+        return 1;
+    }
+    if (mempool.add(makeSpend(keccak256("unknown"), 0, 1.0, 0.1, 1000002), coins.lookup()) !=
+        Mempool::AddResult::MISSING_INPUTS) {
+        std::cerr << "FAIL: accepted an unresolvable input\n";
+        return 1;
+    }
+
+    // Indexed selection
+    size_t selected = 0;
+    auto indexedStart = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < templates; round++) {
+        selected += mempool.selectForBlock(maxBytes, maxCount).size();
+    }
+    double indexedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - indexedStart).count();
+
+    // Baseline: copy the pool and sort it by individual fee rate per template
+    struct Candidate {
+        const Transaction* tx;
+        double feeRate;
+        size_t size;
+    };
+    size_t baselineSelected = 0;
+    auto baselineStart = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < templates; round++) {
+        std::vector<Candidate> candidates;
+        candidates.reserve(mempool.size());
+        mempool.forEach([&candidates](const std::string&, const Transaction& tx) {
+            size_t size = tx.serialize().size();
+            candidates.push_back({&tx, tx.getFee() / size, size});
+        });
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate& a, const Candidate& b) { return a.feeRate > b.feeRate; });
+        size_t bytes = 0;
+        size_t count = 0;
+        for (const auto& candidate : candidates) {
+            if (count == maxCount || bytes + candidate.size > maxBytes) break;
+            bytes += candidate.size;
+            count++;
+        }
+        baselineSelected += count;
+    }
+    double baselineSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - baselineStart).count();
+
+    std::cout << "pool " << mempool.size() << " txs, add " << pending.size() / addSeconds << " tx/s\n";
+    std::cout << "full sort per template: " << 1000.0 * baselineSeconds / templates << " ms ("
+              << baselineSelected / templates << " txs)\n";
+    std::cout << "ancestor score index:   " << 1000.0 * indexedSeconds / templates << " ms ("
+              << selected / templates << " txs)\n";
+    std::cout << "speedup " << baselineSeconds / indexedSeconds << "x\n";
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Block signature verification benchmark: SignatureVerifier over work-stealing pools
+// of several sizes against a serial loop of Crypto::verifySignature, plus a warm pass
+// served from the SignatureCache. Also checks that a bad input is reported by index.
+#include "../include/SignatureVerifier.h"
+#include "../include/SignatureCache.h"
+#include "../include/Crypto.h"
+#include "../include/HashUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static Transaction makeSigned(size_t seed, size_t inputCount) {
+    std::vector<TransactionInput> inputs(inputCount);
+    for (size_t i = 0; i < inputCount; i++) {
+        inputs[i].txHash = keccak256("funding" + std::to_string(seed));
+        inputs[i].outputIndex = static_cast<uint32_t>(i);
+        inputs[i].amount = 1.0;
+    }
+    std::vector<TransactionOutput> outputs(1);
+    outputs[0].address = "GXC" + keccak256("to" + std::to_string(seed)).substr(0, 34);
+    outputs[0].amount = static_cast<double>(inputCount) - 0.001;
+
+    Transaction tx(std::move(inputs), std::move(outputs), keccak256("funding" + std::to_string(seed)));
+    tx.signInputs(keccak256("key" + std::to_string(seed % 64)));
+    return tx;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    const size_t txCount = 1000;
+    const size_t inputsPerTx = 2;
+
+    std::vector<Transaction> block;
+    block.push_back(Transaction("GXCminer", 50.0));
+    for (size_t i = 0; i < txCount; i++) {
+        block.push_back(makeSigned(i, 1 + i % (inputsPerTx * 2 - 1)));
+    }
+    size_t checks = 0;
+    for (const auto& tx : block) {
+        if (!tx.isCoinbaseTransaction()) checks += tx.getInputs().size();
+    }
+
+    // Baseline: every signature checked in turn on the calling thread; the first pass warms up
+    double serialSeconds = 0.0;
+    for (int pass = 0; pass < 2; pass++) {
+        auto serialStart = std::chrono::steady_clock::now();
+        for (const auto& tx : block) {
+            if (tx.isCoinbaseTransaction()) continue;
+            for (const auto& input : tx.getInputs()) {
+                if (!Crypto::verifySignature(Transaction::signatureMessage(input), input.signature, input.publicKey)) {
+                    std::cerr << "FAIL: baseline rejected " << tx.getHash() << "\n";
+                    return 1;
+                }
+            }
+        }
+        serialSeconds = secondsSince(serialStart);
+    }
+
+    std::cout << "hardware threads " << std::thread::hardware_concurrency() << ", " << checks << " signatures\n";
+    std::cout << "serial loop:      " << 1000.0 * serialSeconds << " ms\n";
+
+    std::vector<size_t> poolSizes = {1, 2, 4, std::max<size_t>(1, std::thread::hardware_concurrency())};
+    std::sort(poolSizes.begin(), poolSizes.end());
+    poolSizes.erase(std::unique(poolSizes.begin(), poolSizes.end()), poolSizes.end());
+
+    for (size_t threads : poolSizes) {
+        ThreadPool pool(threads);
+        SignatureVerifier verifier(pool);
+
+        // A cold cache, so every signature is really checked
+        SignatureCache::instance().clear();
+        auto start = std::chrono::steady_clock::now();
+        SignatureVerificationResult result = verifier.verify(block);
+        double seconds = secondsSince(start);
+        if (!result.valid || result.checked != checks) {
+            std::cerr << "FAIL: " << threads << "-thread pool rejected a valid block: " << result.error << "\n";
+            return 1;
+        }
+        std::cout << threads << "-thread pool:    " << 1000.0 * seconds << " ms ("
+                  << serialSeconds / seconds << "x serial)\n";
+    }
+
+    // Warm: the signatures were cached by the last pass, as they are after mempool acceptance
+    {
+        SignatureVerifier verifier;
+        auto start = std::chrono::steady_clock::now();
+        SignatureVerificationResult result = verifier.verify(block);
+        double seconds = secondsSince(start);
+        if (!result.valid) {
+            std::cerr << "FAIL: cached pass rejected a valid block\n";
+            return 1;
+        }
+        std::cout << "cached signatures: " << 1000.0 * seconds << " ms (" << serialSeconds / seconds << "x serial)\n";
+    }
+
+    // A single corrupted input is reported with its transaction and input index
+    std::vector<Transaction> tampered = block;
+    size_t badTx = txCount / 2 + 1;
+    std::string foreign = block[badTx - 1].getInputs()[0].signature;
+    tampered[badTx].setInputSignature(0, std::move(foreign), block[badTx].getInputs()[0].publicKey);
+    SignatureCache::instance().clear();
+    SignatureVerificationResult result = SignatureVerifier().verify(tampered);
+    if (result.valid || result.txIndex != badTx || result.inputIndex != 0 || result.txHash != tampered[badTx].getHash()) {
+        std::cerr << "FAIL: corrupted signature not reported at " << badTx << ":0\n";
+        return 1;
+    }
+    return 0;
+}
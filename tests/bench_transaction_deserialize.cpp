@@ -0,0 +1,305 @@
+// Transaction::deserialize throughput: the single-pass string_view parser against
+// the split-into-strings parser it replaced. Both must decode the same fields.
+// Then the stored JSON records: heap documents against DecodeArena documents, by
+// heap allocations per record and by time.
+#include "../include/transaction.h"
+#include "../include/TransactionBuilder.h"
+#include "../include/DecodeArena.h"
+#include "../include/Utils.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory_resource>
+#include <new>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+// Every operator new in the process; the benchmark is single-threaded
+static size_t heapAllocations = 0;
+
+void* operator new(size_t size) {
+    heapAllocations++;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// Database's read-path document type and its per-record scratch size
+using arena_json = nlohmann::basic_json<std::map, std::vector, std::string, bool, std::int64_t, std::uint64_t,
+                                        double, DecodeArena::Allocator>;
+static const size_t TX_DECODE_SCRATCH_BYTES = 16 * 1024;
+
+// The previous implementation: Utils::split into one heap string per field, then
+// stoull/stod on the copies. Produces the same fields through TransactionBuilder.
+static bool referenceDeserialize(const std::string& data, Transaction& out) {
+    try {
+        std::vector<std::string> parts = Utils::split(data, '|');
+        size_t index = 0;
+        if (parts.size() < 13) return false;
+        
+        auto safeDeserialize = [](const std::string& hexStr) {
+            if (hexStr.empty()) return std::string("");
+            if (Utils::isValidHex(hexStr)) {
+                std::vector<uint8_t> bytes = Utils::fromHex(hexStr);
+                return std::string(bytes.begin(), bytes.end());
+            }
+            return hexStr;
+        };
+        
+        TransactionBuilder builder;
+        builder.setHash(parts[index++]);
+        builder.setTimestamp(std::stoull(parts[index++]));
+        builder.setPrevTxHash(parts[index++]);
+        builder.setReferencedAmount(std::stod(parts[index++]));
+        builder.setSenderAddress(parts[index++]);
+        builder.setReceiverAddress(parts[index++]);
+        builder.setNonce(std::stoul(parts[index++]));
+        builder.setFee(std::stod(parts[index++]));
+        // Memo, lock time, the two flags and the type are parsed and dropped; the
+        // benchmark records leave them at their defaults
+        std::string memo = safeDeserialize(parts[index++]);
+        std::stoul(parts[index++]);
+        index += 2;
+        if (index < parts.size() && Utils::isNumeric(parts[index])) {
+            std::stoi(parts[index++]);
+        }
+        
+        if (index >= parts.size()) return false;
+        size_t inputCount = std::stoul(parts[index++]);
+        for (size_t i = 0; i < inputCount; i++) {
+            if (index + 4 >= parts.size()) return false;
+            TransactionInput input;
+            input.txHash = parts[index++];
+            input.outputIndex = std::stoul(parts[index++]);
+            input.signature = parts[index++];
+            input.amount = std::stod(parts[index++]);
+            input.publicKey = parts[index++];
+            builder.addInput(input);
+        }
+        
+        if (index >= parts.size()) return false;
+        size_t outputCount = std::stoul(parts[index++]);
+        for (size_t i = 0; i < outputCount; i++) {
+            if (index + 2 >= parts.size()) return false;
+            TransactionOutput output;
+            output.address = parts[index++];
+            output.amount = std::stod(parts[index++]);
+            output.script = index < parts.size() ? safeDeserialize(parts[index++]) : std::string();
+            builder.addOutput(output);
+        }
+        
+        out = builder.build();
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+static std::string makeRecord(std::mt19937_64& rng) {
+    // Two decimals and at most six significant digits, which the text format carries exactly
+    auto amount = [](std::mt19937_64& rng) { return static_cast<double>(1 + rng() % 499999) / 100.0; };
+    std::vector<TransactionInput> inputs(2);
+    for (auto& input : inputs) {
+        input.txHash = std::string(64, 'a' + rng() % 6);
+        input.outputIndex = static_cast<uint32_t>(rng() % 4);
+        input.signature = std::string(142, '0' + rng() % 10);
+        input.publicKey = std::string(66, '0' + rng() % 10);
+        input.amount = amount(rng);
+    }
+    std::vector<TransactionOutput> outputs(2);
+    for (auto& output : outputs) {
+        output.address = "GXC" + std::string(34, 'a' + rng() % 26);
+        output.amount = amount(rng);
+        output.script = "OP_DUP OP_HASH160 " + output.address + " OP_EQUALVERIFY OP_CHECKSIG";
+    }
+    Transaction tx(std::move(inputs), std::move(outputs), "");
+    return tx.serialize();
+}
+
+// The tx: record layout Database::serializeTransaction writes
+static std::string toJsonRecord(const Transaction& tx) {
+    nlohmann::json j;
+    j["hash"] = tx.getHash();
+    j["sender"] = tx.getSenderAddress();
+    j["receiver"] = tx.getReceiverAddress();
+    j["fee"] = tx.getFee();
+    j["timestamp"] = tx.getTimestamp();
+    j["nonce"] = tx.getNonce();
+    j["is_coinbase"] = tx.isCoinbaseTransaction();
+    j["prev_tx_hash"] = tx.getPrevTxHash();
+    j["referenced_amount"] = tx.getReferencedAmount();
+    j["inputs"] = nlohmann::json::array();
+    for (const auto& input : tx.getInputs()) {
+        j["inputs"].push_back({{"tx_hash", input.txHash}, {"output_index", input.outputIndex},
+                               {"amount", input.amount}, {"signature", input.signature}});
+    }
+    j["outputs"] = nlohmann::json::array();
+    for (const auto& output : tx.getOutputs()) {
+        j["outputs"].push_back({{"address", output.address}, {"amount", output.amount}, {"script", output.script}});
+    }
+    return j.dump();
+}
+
+// Database's transactionFromJson; take() copies or moves each string out
+template <typename Json, typename Take>
+static Transaction fromDocument(Json& j, Take&& take) {
+    TransactionBuilder builder;
+    builder.setHash(take(j["hash"]))
+           .setSenderAddress(take(j["sender"]))
+           .setReceiverAddress(take(j["receiver"]))
+           .setFee(j["fee"].template get<double>())
+           .setTimestamp(j["timestamp"].template get<uint64_t>())
+           .setNonce(j["nonce"].template get<uint64_t>())
+           .setCoinbase(j["is_coinbase"].template get<bool>())
+           .setPrevTxHash(take(j["prev_tx_hash"]))
+           .setReferencedAmount(j["referenced_amount"].template get<double>())
+           .reserve(j["inputs"].size(), j["outputs"].size());
+    for (auto& inp : j["inputs"]) {
+        TransactionInput input;
+        input.txHash = take(inp["tx_hash"]);
+        input.outputIndex = inp["output_index"].template get<uint32_t>();
+        input.amount = inp["amount"].template get<double>();
+        input.signature = take(inp["signature"]);
+        builder.addInput(std::move(input));
+    }
+    for (auto& out : j["outputs"]) {
+        TransactionOutput output;
+        output.address = take(out["address"]);
+        output.amount = out["amount"].template get<double>();
+        output.script = take(out["script"]);
+        builder.addOutput(std::move(output));
+    }
+    return builder.build();
+}
+
+static Transaction heapDecode(const std::string& record) {
+    nlohmann::json j = nlohmann::json::parse(record);
+    return fromDocument(j, [](const nlohmann::json& value) { return value.get<std::string>(); });
+}
+
+// As Database::getTransactionsByBlockHash decodes: one scratch buffer rewound per record
+static Transaction arenaDecode(const std::string& record, std::pmr::monotonic_buffer_resource& arena) {
+    Transaction tx;
+    {
+        DecodeArena::Scope scope(&arena);
+        arena_json j = arena_json::parse(record);
+        tx = fromDocument(j, [](arena_json& value) { return std::move(value.get_ref<std::string&>()); });
+    }
+    arena.release();
+    return tx;
+}
+
+struct DecodeCost {
+    double allocationsPerRecord;
+    double microsecondsPerRecord;
+};
+
+template <typename Decode>
+static DecodeCost measureDecode(const std::vector<std::string>& records, size_t rounds, Decode&& decode) {
+    size_t decoded = 0;
+    size_t allocationsBefore = heapAllocations;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+        for (const auto& record : records) {
+            decoded += decode(record).getInputs().size() == 2 ? 1 : 0;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (decoded != records.size() * rounds) {
+        std::cerr << "FAIL: a JSON record did not decode\n";
+        std::exit(1);
+    }
+    double count = static_cast<double>(records.size() * rounds);
+    return {(heapAllocations - allocationsBefore) / count, seconds / count * 1e6};
+}
+
+template <typename Parse>
+static double recordsPerSecond(const std::vector<std::string>& records, size_t rounds, Parse&& parse) {
+    size_t parsed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+        for (const auto& record : records) {
+            Transaction tx;
+            parsed += parse(record, tx) ? 1 : 0;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (parsed != records.size() * rounds) {
+        std::cerr << "FAIL: a benchmark record did not parse\n";
+        std::exit(1);
+    }
+    return static_cast<double>(parsed) / seconds;
+}
+
+int main() {
+    std::mt19937_64 rng(42);
+    std::vector<std::string> records;
+    for (size_t i = 0; i < 20000; i++) {
+        records.push_back(makeRecord(rng));
+    }
+    
+    for (const auto& record : records) {
+        Transaction fast;
+        Transaction reference;
+        if (!fast.deserialize(record) || !referenceDeserialize(record, reference) ||
+            fast.getHash() != reference.getHash() || fast.getInputs().size() != reference.getInputs().size() ||
+            fast.getTotalInputAmount() != reference.getTotalInputAmount() ||
+            fast.getTotalOutputAmount() != reference.getTotalOutputAmount() ||
+            fast.getOutputs()[1].script != reference.getOutputs()[1].script) {
+            std::cerr << "FAIL: parsers disagree on " << record << "\n";
+            return 1;
+        }
+    }
+    
+    const size_t rounds = 10;
+    double reference = recordsPerSecond(records, rounds, referenceDeserialize);
+    double streamed = recordsPerSecond(records, rounds, [](const std::string& record, Transaction& tx) {
+        return tx.deserialize(record);
+    });
+    double verified = recordsPerSecond(records, rounds, [](const std::string& record, Transaction& tx) {
+        return tx.deserialize(record, true);
+    });
+    
+    std::cout << "split + stod:              " << static_cast<uint64_t>(reference) << " records/s\n"
+              << "single pass:               " << static_cast<uint64_t>(streamed) << " records/s ("
+              << streamed / reference << "x)\n"
+              << "single pass + hash check:  " << static_cast<uint64_t>(verified) << " records/s\n";
+    
+    // Stored JSON records, decoded the way the read path does
+    std::vector<std::string> jsonRecords;
+    for (size_t i = 0; i < 2000; i++) {
+        Transaction tx;
+        tx.deserialize(records[i]);
+        jsonRecords.push_back(toJsonRecord(tx));
+    }
+    std::vector<char> scratch(TX_DECODE_SCRATCH_BYTES);
+    std::pmr::monotonic_buffer_resource arena(scratch.data(), scratch.size());
+    for (const auto& record : jsonRecords) {
+        Transaction heap = heapDecode(record);
+        Transaction arenaDecoded = arenaDecode(record, arena);
+        if (heap.getHash() != arenaDecoded.getHash() || heap.getOutputs()[1].script != arenaDecoded.getOutputs()[1].script) {
+            std::cerr << "FAIL: heap and arena documents disagree on " << record << "\n";
+            return 1;
+        }
+    }
+    
+    DecodeCost heapCost = measureDecode(jsonRecords, rounds, heapDecode);
+    DecodeCost arenaCost = measureDecode(jsonRecords, rounds, [&](const std::string& record) {
+        return arenaDecode(record, arena);
+    });
+    std::cout << "JSON record, heap document:  " << heapCost.allocationsPerRecord << " allocations, "
+              << heapCost.microsecondsPerRecord << " us\n"
+              << "JSON record, arena document: " << arenaCost.allocationsPerRecord << " allocations, "
+              << arenaCost.microsecondsPerRecord << " us\n";
+    return 0;
+}
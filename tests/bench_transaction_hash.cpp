@@ -0,0 +1,87 @@
+// Transaction hashing benchmark: the streamed txid preimage against the
+// stringstream-built preimage it replaced. Both must produce the same txid.
+#include "../include/transaction.h"
+#include "../include/HashUtils.h"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// The pre-streaming calculateHash(), kept as the reference. makeTransaction leaves
+// memo, lockTime and type at their defaults ("", 0, NORMAL) and is never gold-backed.
+static std::string referenceHash(const Transaction& tx) {
+    std::stringstream ss;
+    for (const auto& input : tx.getInputs()) {
+        ss << input.txHash << input.outputIndex << input.signature << input.amount << input.publicKey;
+    }
+    for (const auto& output : tx.getOutputs()) {
+        ss << output.address << output.amount << output.script;
+    }
+    ss << tx.getTimestamp() << tx.getPrevTxHash() << tx.getReferencedAmount() << tx.getSenderAddress()
+       << tx.getReceiverAddress() << tx.getNonce() << tx.getFee() << "" << 0;
+    ss << 0;
+    if (tx.isCoinbaseTransaction()) {
+        ss << "COINBASE";
+    }
+    return keccak256(ss.str());
+}
+
+static Transaction makeTransaction(size_t seed, size_t inputCount, size_t outputCount) {
+    std::vector<TransactionInput> inputs(inputCount);
+    for (size_t i = 0; i < inputCount; i++) {
+        inputs[i].txHash = keccak256("prev" + std::to_string(seed * 31 + i));
+        inputs[i].outputIndex = static_cast<uint32_t>(i);
+        inputs[i].signature = std::string(142, 'a' + (seed + i) % 26);
+        inputs[i].publicKey = std::string(66, '0' + (seed + i) % 10);
+        inputs[i].amount = 1234.56789 + static_cast<double>(seed % 1000) / 7.0;
+    }
+    std::vector<TransactionOutput> outputs(outputCount);
+    for (size_t i = 0; i < outputCount; i++) {
+        outputs[i].address = "GXC" + keccak256("addr" + std::to_string(seed + i)).substr(0, 34);
+        outputs[i].amount = 0.00012345 * static_cast<double>(seed + i + 1);
+        outputs[i].script = "OP_DUP OP_HASH160 " + outputs[i].address + " OP_EQUALVERIFY OP_CHECKSIG";
+    }
+    Transaction tx(std::move(inputs), std::move(outputs), "");
+    tx.setFee(0.001 * static_cast<double>(seed % 13));
+    return tx;
+}
+
+template <typename Fn>
+static double hashesPerSecond(const std::vector<Transaction>& txs, size_t rounds, Fn&& hash) {
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+        for (const auto& tx : txs) {
+            sink += hash(tx).size();
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 0) std::cout << "";
+    return static_cast<double>(txs.size() * rounds) / seconds;
+}
+
+int main() {
+    const size_t count = 20000;
+    const size_t rounds = 5;
+    
+    std::vector<Transaction> txs;
+    txs.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        txs.push_back(makeTransaction(i, 1 + i % 3, 2));
+    }
+    
+    for (const auto& tx : txs) {
+        if (tx.calculateHash() != referenceHash(tx)) {
+            std::cerr << "FAIL: streamed preimage differs from the stringstream preimage\n";
+            return 1;
+        }
+    }
+    
+    double reference = hashesPerSecond(txs, rounds, referenceHash);
+    double streamed = hashesPerSecond(txs, rounds, [](const Transaction& tx) { return tx.calculateHash(); });
+    
+    std::cout << "stringstream preimage: " << static_cast<uint64_t>(reference) << " hashes/s\n"
+              << "streamed preimage:     " << static_cast<uint64_t>(streamed) << " hashes/s\n"
+              << "speedup:               " << streamed / reference << "x\n";
+    return 0;
+}
@@ -0,0 +1,111 @@
+// Address queries against a scratch database: balances and UTXO lists for several
+// addresses at once, including repeated and unknown addresses, and transaction
+// history across a replaced and a deleted block.
+#include "../include/Database.h"
+#include "../include/HashUtils.h"
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+static Block makeBlock(uint32_t height, const std::string& tag, const std::vector<Transaction>& transactions) {
+    Block block(height, keccak256("prev" + std::to_string(height)), BlockType::POW_SHA256);
+    block.setHash(keccak256(tag));
+    block.setTimestamp(1700000000 + height);
+    for (const auto& tx : transactions) {
+        block.addTransaction(tx);
+    }
+    return block;
+}
+
+static Transaction spend(const Transaction& from, uint32_t index, double amount,
+                         const std::vector<std::pair<std::string, double>>& payments) {
+    std::vector<TransactionInput> inputs(1);
+    inputs[0].txHash = from.getHash();
+    inputs[0].outputIndex = index;
+    inputs[0].amount = amount;
+    std::vector<TransactionOutput> outputs;
+    for (const auto& payment : payments) {
+        TransactionOutput output;
+        output.address = payment.first;
+        output.amount = payment.second;
+        outputs.push_back(output);
+    }
+    return Transaction(std::move(inputs), std::move(outputs), from.getHash());
+}
+
+int main() {
+    const std::string path = (std::filesystem::temp_directory_path() / "gxc_test_address_queries").string();
+    std::filesystem::remove_all(path);
+    if (!Database::initialize(path)) {
+        std::cerr << "FAIL: cannot open " << path << "\n";
+        return 1;
+    }
+    Database& db = Database::getInstance();
+
+    Transaction reward("GXCalice", 50.0);
+    Transaction payment = spend(reward, 0, 50.0, {{"GXCbob", 30.0}, {"GXCalice", 19.5}, {"GXCbob", 0.5}});
+    check(db.saveBlock(makeBlock(0, "genesis", {reward})), "block 0 saved");
+    check(db.saveBlock(makeBlock(1, "one", {Transaction("GXCcarol", 50.0), payment})), "block 1 saved");
+
+    std::vector<std::string> query = {"GXCbob", "GXCalice", "GXCnobody", "GXCbob", "GXCbob"};
+
+    std::vector<double> balances = db.getAddressBalances(query);
+    check(balances.size() == query.size(), "one balance per address");
+    check(balances[0] == 30.5 && balances[3] == 30.5 && balances[4] == 30.5, "repeated address balance");
+    check(balances[1] == 19.5 && balances[2] == 0.0, "single and unknown address balance");
+
+    // Every occurrence of a repeated address gets the full list, the last one included
+    std::vector<std::vector<AddressUtxo>> utxos = db.getUTXOsByAddresses(query);
+    check(utxos.size() == query.size(), "one UTXO list per address");
+    check(utxos[0].size() == 2 && utxos[3].size() == 2 && utxos[4].size() == 2, "repeated address UTXOs");
+    check(utxos[1].size() == 1 && utxos[1][0].outputIndex == 1 && utxos[1][0].txHash == payment.getHash(),
+          "single address UTXO");
+    check(utxos[2].empty(), "unknown address has no UTXOs");
+    for (size_t i : {0, 3, 4}) {
+        for (const auto& utxo : utxos[i]) {
+            check(utxo.output.address == "GXCbob" && utxo.blockHeight == 1, "repeated list describes bob's outputs");
+        }
+    }
+
+    // Addresses that prefix one another stay apart
+    std::vector<double> prefixed = db.getAddressBalances({"GXC", "GXCbo", "GXCbob"});
+    check(prefixed[0] == 0.0 && prefixed[1] == 0.0 && prefixed[2] == 30.5, "prefix addresses are distinct");
+
+    // History follows the chain: a replaced or deleted block leaves no rows behind
+    std::string cursor;
+    Transaction toDave = spend(payment, 0, 30.0, {{"GXCdave", 30.0}});
+    check(db.saveBlock(makeBlock(2, "two", {Transaction("GXCminer", 50.0), toDave})), "block 2 saved");
+    check(db.getAddressHistory("GXCdave", "", 10, false, cursor).size() == 1, "payment in history");
+    check(db.getAddressHistory("GXCbob", "", 10, false, cursor).size() == 2, "spend in sender history");
+
+    check(db.saveBlock(makeBlock(2, "two-b", {Transaction("GXCerin", 50.0)})), "replacement block 2 saved");
+    check(db.getAddressHistory("GXCdave", "", 10, false, cursor).empty(), "replaced payment leaves history");
+    check(db.getAddressHistory("GXCminer", "", 10, false, cursor).empty(), "replaced reward leaves history");
+    std::vector<AddressHistoryEntry> bobHistory = db.getAddressHistory("GXCbob", "", 10, false, cursor);
+    check(bobHistory.size() == 1 && bobHistory[0].blockHeight == 1, "sender history back to block 1");
+    std::vector<AddressHistoryEntry> erinHistory = db.getAddressHistory("GXCerin", "", 10, false, cursor);
+    check(erinHistory.size() == 1 && erinHistory[0].blockHeight == 2, "replacement block in history");
+
+    check(db.deleteBlock(2), "block 2 deleted");
+    check(db.getAddressHistory("GXCerin", "", 10, false, cursor).empty(), "deleted block leaves history");
+    check(db.getAddressHistory("GXCbob", "", 10, false, cursor).size() == 1, "earlier history kept");
+
+    Database::shutdown();
+    std::filesystem::remove_all(path);
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "address query tests passed\n";
+    return 0;
+}
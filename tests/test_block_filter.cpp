@@ -0,0 +1,103 @@
+// Golomb-coded block filters: encodings decode back to the same set, malformed
+// encodings are refused, and the false-positive rate per query element stays near
+// the designed 1 in M.
+#include "../include/BlockFilter.h"
+#include "../include/HashUtils.h"
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+static std::vector<std::string> members(const std::string& tag, size_t count) {
+    std::vector<std::string> elements;
+    for (size_t i = 0; i < count; i++) {
+        elements.push_back(tag + std::to_string(i));
+    }
+    return elements;
+}
+
+static void testRoundTrip() {
+    // 1000 elements puts a multi-byte CompactSize in front of the stream
+    for (size_t count : {1, 2, 252, 253, 1000}) {
+        std::string blockHash = keccak256("block" + std::to_string(count));
+        std::vector<std::string> elements = members("member", count);
+        BlockFilter built = BlockFilter::build(blockHash, elements);
+        check(built.getElementCount() == count, std::to_string(count) + ": element count kept");
+
+        BlockFilter decoded;
+        check(BlockFilter::fromEncoded(blockHash, built.getEncoded(), decoded), std::to_string(count) + ": decodes");
+        check(decoded.getElementCount() == count, std::to_string(count) + ": decoded count");
+        check(decoded.getFilterHash() == built.getFilterHash(), std::to_string(count) + ": filter hash survives");
+
+        bool all = true;
+        for (const auto& element : elements) {
+            all = all && decoded.match(element);
+        }
+        check(all, std::to_string(count) + ": every member matches after decoding");
+        check(decoded.matchAny({"not a member", elements.back()}), std::to_string(count) + ": matchAny finds a member");
+    }
+
+    // Duplicates and empty strings are dropped, and an empty filter matches nothing
+    BlockFilter deduplicated = BlockFilter::build(keccak256("dup"), {"a", "b", "a", "", "b"});
+    check(deduplicated.getElementCount() == 2, "duplicates and empty elements dropped");
+    BlockFilter empty = BlockFilter::build(keccak256("empty"), {});
+    BlockFilter emptyDecoded;
+    check(BlockFilter::fromEncoded(keccak256("empty"), empty.getEncoded(), emptyDecoded) &&
+          emptyDecoded.getElementCount() == 0 && !emptyDecoded.match("a"), "empty filter round trips");
+}
+
+static void testMalformed() {
+    std::string blockHash = keccak256("malformed");
+    BlockFilter built = BlockFilter::build(blockHash, members("member", 300));
+    const std::string& encoded = built.getEncoded();
+    BlockFilter decoded;
+
+    check(!BlockFilter::fromEncoded(blockHash, "", decoded), "empty encoding refused");
+    check(!BlockFilter::fromEncoded(blockHash, encoded.substr(0, 2), decoded), "truncated CompactSize refused");
+    check(!BlockFilter::fromEncoded(blockHash, encoded.substr(0, encoded.size() / 2), decoded),
+          "count larger than the stream can hold refused");
+    check(!BlockFilter::fromEncoded(blockHash, std::string("\xff\xff\xff\xff\xff\xff\xff\xff\xff", 9), decoded),
+          "huge count refused");
+}
+
+static void testFalsePositiveRate() {
+    // Each batch of M / 4 non-members hits a filter with probability 1 - e^(-1/4) when
+    // the per-element rate is 1 / M; the rate is recovered from the share of hits.
+    // Inputs are fixed, so the outcome is deterministic.
+    const size_t filters = 200;
+    const size_t queriesPerFilter = BlockFilter::M / 4;
+    size_t hits = 0;
+    for (size_t f = 0; f < filters; f++) {
+        std::string tag = "filter" + std::to_string(f) + ":";
+        BlockFilter filter = BlockFilter::build(keccak256(tag), members(tag, 500));
+        if (filter.matchAny(members("miss" + tag, queriesPerFilter))) {
+            hits++;
+        }
+    }
+
+    double hitShare = static_cast<double>(hits) / filters;
+    double rate = -std::log(1.0 - hitShare) / queriesPerFilter;
+    double expected = 1.0 / BlockFilter::M;
+    std::cout << "false-positive rate " << rate << " per element (designed " << expected << ")\n";
+    check(rate > expected / 2 && rate < expected * 2, "false-positive rate within 2x of 1/M");
+}
+
+int main() {
+    testRoundTrip();
+    testMalformed();
+    testFalsePositiveRate();
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "block filter tests passed\n";
+    return 0;
+}
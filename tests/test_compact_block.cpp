@@ -0,0 +1,171 @@
+// Compact block relay, offline: a block is announced against a synthetic mempool,
+// rebuilt from short IDs plus the one transaction the pool lacks, and compared with
+// the original. Reports the bytes saved over full relay and the reconstruction time.
+#include "../include/CompactBlock.h"
+#include "../include/Mempool.h"
+#include "../include/HashUtils.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+static Transaction makeTransaction(size_t seed) {
+    std::vector<TransactionInput> inputs(1);
+    inputs[0].txHash = keccak256("funding" + std::to_string(seed));
+    inputs[0].outputIndex = 0;
+    inputs[0].amount = 10.0;
+    inputs[0].signature = std::string(142, 'a' + seed % 26);
+    inputs[0].publicKey = std::string(66, '0' + seed % 10);
+
+    std::vector<TransactionOutput> outputs(2);
+    for (size_t i = 0; i < outputs.size(); i++) {
+        outputs[i].address = "GXC" + keccak256("addr" + std::to_string(seed * 2 + i)).substr(0, 34);
+        outputs[i].amount = 4.99 + 0.000000013 * static_cast<double>(seed % 1000);
+        outputs[i].script = "OP_DUP OP_HASH160 " + outputs[i].address + " OP_EQUALVERIFY OP_CHECKSIG";
+    }
+    return Transaction(std::move(inputs), std::move(outputs), keccak256("funding" + std::to_string(seed)));
+}
+
+static void testRoundTrip() {
+    const size_t blockSize = 3000;
+    const size_t poolExtra = 2000;
+
+    // Every synthetic input spends a 10-coin confirmed output
+    Mempool::CoinLookup coins = [](const std::string&, uint32_t outputIndex, TransactionOutput& output) {
+        if (outputIndex != 0) return false;
+        output.amount = 10.0;
+        return true;
+    };
+
+    Mempool mempool(Mempool::DEFAULT_MAX_MEMORY);
+    std::vector<Transaction> pool;
+    for (size_t i = 0; i < blockSize + poolExtra; i++) {
+        pool.push_back(makeTransaction(i));
+        check(mempool.add(pool.back(), coins) == Mempool::AddResult::ADDED, "synthetic transaction accepted");
+    }
+
+    Block block(7, keccak256("prev"), BlockType::POW_SHA256);
+    block.setHash(keccak256("block"));
+    block.setMerkleRoot(keccak256("merkle"));
+    block.setTimestamp(1700000000);
+    block.setDifficulty(1.5);
+    block.setNonce(9);
+    block.setMinerAddress("GXCminer");
+
+    // A reward whose digits run past what the text encoding of old kept
+    Transaction coinbase("GXCminer", 50.123456789012345);
+    block.addTransaction(coinbase);
+    for (size_t i = 0; i < blockSize; i++) {
+        block.addTransaction(pool[i]);
+    }
+    Transaction unseen = makeTransaction(999999);
+    block.addTransaction(unseen);
+
+    size_t fullBytes = 0;
+    for (const auto& tx : block.getTransactions()) {
+        fullBytes += tx.serialize().size();
+    }
+
+    CompactBlock compact = CompactBlock::fromBlock(block, 0x1234);
+    std::string wire = compact.serialize();
+
+    CompactBlock received;
+    check(CompactBlock::deserialize(wire, received), "compact block decodes");
+    check(received.shortIds == compact.shortIds, "short IDs survive the wire");
+    check(received.prefilled.size() == 1 && received.prefilled[0].index == 0, "only the coinbase is prefilled");
+    check(received.difficulty == 1.5 && received.hash == compact.hash, "header survives the wire");
+
+    const Transaction& prefilled = received.prefilled[0].tx;
+    check(prefilled.getOutputs()[0].amount == coinbase.getOutputs()[0].amount, "coinbase amount is exact");
+    check(prefilled.isCoinbaseTransaction(), "coinbase flag survives");
+    check(prefilled.getHash() == coinbase.getHash(), "coinbase hash is recomputed to the original");
+
+    auto start = std::chrono::steady_clock::now();
+    PartialBlock partial(received);
+    PartialBlock::Status status = partial.fill(mempool);
+    double fillMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    check(status == PartialBlock::Status::MISSING, "one transaction is missing");
+    std::vector<uint32_t> missing = partial.getMissing();
+    check(missing.size() == 1 && missing[0] == blockSize + 1, "the unseen transaction is the one requested");
+
+    // The peer answers in the binary encoding too
+    Transaction answered;
+    check(answered.deserializeBinary(unseen.serializeBinary()), "missing transaction decodes");
+    check(partial.supplyMissing({answered}) == PartialBlock::Status::READY, "block completes");
+
+    Block rebuilt;
+    check(partial.build(rebuilt), "block builds");
+    check(rebuilt.getTransactions().size() == block.getTransactions().size(), "transaction count matches");
+    for (size_t i = 0; i < rebuilt.getTransactions().size() && i < block.getTransactions().size(); i++) {
+        if (rebuilt.getTransactions()[i].getHash() != block.getTransactions()[i].getHash()) {
+            check(false, "rebuilt transaction hash matches");
+            break;
+        }
+    }
+
+    std::cout << "transactions " << block.getTransactions().size() << ", pool " << mempool.size() << "\n";
+    std::cout << "full relay " << fullBytes << " bytes, compact " << wire.size() << " bytes ("
+              << 100.0 * (1.0 - static_cast<double>(wire.size()) / fullBytes) << "% saved)\n";
+    std::cout << "reconstruction from pool " << fillMicros << " us\n";
+
+    // Truncated or padded announcements are rejected
+    CompactBlock rejected;
+    check(!CompactBlock::deserialize(wire.substr(0, wire.size() - 3), rejected), "truncated block rejected");
+    check(!CompactBlock::deserialize(wire + "x", rejected), "trailing bytes rejected");
+}
+
+static void testBinaryEncoding() {
+    Transaction tx = makeTransaction(42);
+    tx.setFee(0.1 + 0.2);
+    std::string encoded = tx.serializeBinary();
+
+    Transaction decoded;
+    check(decoded.deserializeBinary(encoded), "binary transaction decodes");
+    check(decoded.getFee() == tx.getFee(), "fee is exact");
+    check(decoded.getHash() == tx.getHash(), "hash matches after decode");
+    check(decoded.serializeBinary() == encoded, "re-encoding is identical");
+
+    // Every strict prefix is rejected, and a stale hash never survives a failed decode
+    for (size_t length = 0; length < encoded.size(); length++) {
+        Transaction partial = makeTransaction(7);
+        partial.getHash();
+        if (partial.deserializeBinary(std::string_view(encoded).substr(0, length))) {
+            check(false, "truncated transaction rejected");
+            break;
+        }
+        if (partial.getHash() != partial.calculateHash()) {
+            check(false, "failed decode leaves no stale hash");
+            break;
+        }
+    }
+
+    // A huge declared input count fails before allocating
+    // (an empty transaction ends with the 4-byte input count and the 4-byte output count)
+    std::string inflated = Transaction().serializeBinary();
+    size_t countOffset = inflated.size() - 8;
+    inflated[countOffset] = '\xff';
+    inflated[countOffset + 1] = '\xff';
+    inflated[countOffset + 2] = '\xff';
+    inflated[countOffset + 3] = '\x7f';
+    check(!decoded.deserializeBinary(inflated), "oversized input count rejected");
+}
+
+int main() {
+    testBinaryEncoding();
+    testRoundTrip();
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "compact block tests passed\n";
+    return 0;
+}
@@ -0,0 +1,152 @@
+// KeccakBatch: every SIMD implementation the CPU offers must reproduce the scalar
+// sponge for messages of any length and for batches of any size, then each one is
+// timed on transaction-sized messages.
+#include "../include/KeccakBatch.h"
+#include "../include/KeccakHasher.h"
+#include "../include/HashUtils.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+static Hash256 scalarDigest(const std::string& message) {
+    Hash256 digest;
+    KeccakHasher hasher;
+    hasher.update(message);
+    hasher.finalize(digest.bytes.data());
+    return digest;
+}
+
+static std::vector<std::string> randomMessages(std::mt19937& rng, size_t count, size_t maxLength) {
+    std::uniform_int_distribution<size_t> length(0, maxLength);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::string> messages(count);
+    for (auto& message : messages) {
+        message.resize(length(rng));
+        for (auto& c : message) {
+            c = static_cast<char>(byte(rng));
+        }
+    }
+    return messages;
+}
+
+static const char* name(KeccakBatch::Implementation impl) {
+    switch (impl) {
+        case KeccakBatch::Implementation::AVX512: return "avx512";
+        case KeccakBatch::Implementation::AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+// The SIMD paths disable themselves when their start-up self-test fails, so a CPU that
+// has the instructions but did not get the implementation points at a broken lane
+static bool cpuHas(KeccakBatch::Implementation impl) {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    if (impl == KeccakBatch::Implementation::AVX512) return __builtin_cpu_supports("avx512f");
+    if (impl == KeccakBatch::Implementation::AVX2) return __builtin_cpu_supports("avx2");
+#endif
+    return impl == KeccakBatch::Implementation::SCALAR;
+}
+
+static void testEquivalence(KeccakBatch::Implementation impl, std::mt19937& rng) {
+    const std::string label = name(impl);
+
+    // Every length across three rate blocks, in one batch so lanes finish at different blocks
+    std::vector<std::string> byLength;
+    for (size_t length = 0; length <= 3 * KeccakHasher::RATE + 1; length++) {
+        std::string message(length, '\0');
+        for (size_t i = 0; i < length; i++) {
+            message[i] = static_cast<char>((i * 131 + length * 7) & 0xff);
+        }
+        byLength.push_back(std::move(message));
+    }
+    std::vector<std::string_view> views(byLength.begin(), byLength.end());
+    std::vector<Hash256> digests = KeccakBatch::hash(views);
+    for (size_t i = 0; i < byLength.size(); i++) {
+        if (digests[i] != scalarDigest(byLength[i])) {
+            check(false, label + " digest of a " + std::to_string(i) + "-byte message");
+            break;
+        }
+    }
+
+    // Batch sizes around the lane count leave groups partly filled
+    for (size_t count = 0; count <= 2 * KeccakBatch::lanes() + 1; count++) {
+        std::vector<std::string> messages = randomMessages(rng, count, 600);
+        std::vector<std::string_view> batch(messages.begin(), messages.end());
+        std::vector<Hash256> batchDigests = KeccakBatch::hash(batch);
+        for (size_t i = 0; i < count; i++) {
+            if (batchDigests[i] != scalarDigest(messages[i])) {
+                check(false, label + " digest in a batch of " + std::to_string(count));
+                break;
+            }
+        }
+    }
+
+    // Hex digests agree with keccak256() itself
+    std::vector<std::string> messages = randomMessages(rng, 1001, 1200);
+    std::vector<std::string> hex = KeccakBatch::hashHex(messages);
+    for (size_t i = 0; i < messages.size(); i++) {
+        if (hex[i] != keccak256(messages[i])) {
+            check(false, label + " hex digest matches keccak256()");
+            break;
+        }
+    }
+}
+
+static void benchmark(KeccakBatch::Implementation impl, const std::vector<std::string>& messages) {
+    std::vector<std::string_view> views(messages.begin(), messages.end());
+    std::vector<Hash256> digests(views.size());
+    size_t bytes = 0;
+    for (const auto& message : messages) {
+        bytes += message.size();
+    }
+
+    KeccakBatch::hash(views.data(), views.size(), digests.data());
+    auto start = std::chrono::steady_clock::now();
+    const int rounds = 5;
+    for (int round = 0; round < rounds; round++) {
+        KeccakBatch::hash(views.data(), views.size(), digests.data());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / rounds;
+    std::cout << name(impl) << ": " << messages.size() / seconds / 1e6 << "M msg/s, "
+              << bytes / seconds / (1024 * 1024) << " MB/s\n";
+}
+
+int main() {
+    std::mt19937 rng(38);
+    const KeccakBatch::Implementation detected = KeccakBatch::implementation();
+    std::cout << "detected implementation " << KeccakBatch::implementationName() << "\n";
+
+    // Transaction preimages run a few hundred bytes
+    std::vector<std::string> messages = randomMessages(rng, 200000, 600);
+
+    for (auto impl : {KeccakBatch::Implementation::SCALAR, KeccakBatch::Implementation::AVX2,
+                      KeccakBatch::Implementation::AVX512}) {
+        KeccakBatch::setImplementation(impl);
+        if (KeccakBatch::implementation() != impl) {
+            check(!cpuHas(impl) || KeccakHasher::padding() == 0,
+                  std::string(name(impl)) + " failed its self-test on a CPU that supports it");
+            std::cout << name(impl) << ": not available\n";
+            continue;
+        }
+        testEquivalence(impl, rng);
+        benchmark(impl, messages);
+    }
+    KeccakBatch::setImplementation(detected);
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "keccak batch tests passed\n";
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Script templates: addresses decode to bytes without making distinct texts equal,
+// outputs are classified when built or decoded, and verifyScript matches a public key
+// against the stored classification through the shared derivation cache.
+#include "../include/transaction.h"
+#include "../include/ScriptTemplate.h"
+#include "../include/Crypto.h"
+#include "../include/HashUtils.h"
+#include <cctype>
+#include <iostream>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+static std::string p2pkh(const std::string& address) {
+    return "OP_DUP OP_HASH160 " + address + " OP_EQUALVERIFY OP_CHECKSIG";
+}
+
+static void testDecode() {
+    DecodedAddress mainnet = DecodedAddress::decode("GXC00ff10");
+    check(mainnet.form == DecodedAddress::Form::HEX && !mainnet.testnet && mainnet.bytes == std::string("\x00\xff\x10", 3),
+          "mainnet hex body decodes to bytes");
+    DecodedAddress testnet = DecodedAddress::decode("tGXC00ff10");
+    check(testnet.form == DecodedAddress::Form::HEX && testnet.testnet && testnet.bytes == mainnet.bytes,
+          "testnet prefix sets the network");
+    check(testnet != mainnet, "same body on different networks differs");
+
+    // Texts that do not decode are kept whole and never equal a decoded address
+    check(DecodedAddress::decode("GXC00FF10").form == DecodedAddress::Form::TEXT, "uppercase hex kept as text");
+    check(DecodedAddress::decode("GXC00FF10") != mainnet, "case variants stay distinct");
+    check(DecodedAddress::decode("GXC00f").form == DecodedAddress::Form::TEXT, "odd-length body kept as text");
+    check(DecodedAddress::decode("GXC").form == DecodedAddress::Form::TEXT, "empty body kept as text");
+    DecodedAddress foreign = DecodedAddress::decode("1BoatSLRHtKNngkdXEeobR76b53LETtpyT");
+    check(foreign.form == DecodedAddress::Form::TEXT && foreign.bytes == "1BoatSLRHtKNngkdXEeobR76b53LETtpyT",
+          "unprefixed address kept verbatim");
+    check(DecodedAddress::decode("tGXCzz").testnet, "undecodable testnet address keeps its network");
+}
+
+static void testClassification() {
+    std::string address = Crypto::generateAddress(Crypto::derivePublicKey("alice"), false);
+
+    ScriptTemplate standard = ScriptTemplate::classify(p2pkh(address));
+    check(standard.type == ScriptTemplate::Type::P2PKH, "standard script is P2PKH");
+    check(standard.address == DecodedAddress::decode(address), "P2PKH locks to the decoded address");
+    check(ScriptTemplate::classify(address).type == ScriptTemplate::Type::BARE_ADDRESS, "bare address script");
+    check(ScriptTemplate::classify("OP_RETURN 00").type == ScriptTemplate::Type::UNKNOWN, "other scripts unknown");
+
+    // Built and decoded outputs carry their classification
+    std::vector<TransactionInput> inputs(1);
+    inputs[0].txHash = keccak256("funding");
+    inputs[0].amount = 1.0;
+    std::vector<TransactionOutput> outputs(1);
+    outputs[0].address = address;
+    outputs[0].amount = 1.0;
+    outputs[0].script = p2pkh(address);
+    Transaction tx(std::move(inputs), std::move(outputs), keccak256("funding"));
+    check(tx.getOutputs()[0].scriptTemplate.type == ScriptTemplate::Type::P2PKH, "constructed output classified");
+
+    Transaction decoded;
+    check(decoded.deserializeBinary(tx.serializeBinary()), "transaction decodes");
+    check(decoded.getOutputs()[0].scriptTemplate.address == standard.address, "decoded output classified");
+
+    Transaction coinbase(address, 50.0);
+    check(coinbase.getOutputs()[0].scriptTemplate.type == ScriptTemplate::Type::P2PKH, "coinbase output classified");
+}
+
+static void testVerifyScript() {
+    AddressCache::clear();
+    std::string alice = Crypto::derivePublicKey("alice");
+    std::string bob = Crypto::derivePublicKey("bob");
+
+    Transaction mainnet(Crypto::generateAddress(alice, false), 50.0);
+    Transaction testnet(Crypto::generateAddress(alice, true), 50.0);
+    const TransactionOutput& mainnetOutput = mainnet.getOutputs()[0];
+    const TransactionOutput& testnetOutput = testnet.getOutputs()[0];
+
+    check(Transaction::verifyScript("", alice, mainnetOutput), "owner key unlocks the output");
+    check(!Transaction::verifyScript("", bob, mainnetOutput), "other key is refused");
+    check(Transaction::verifyScript("", alice, testnetOutput), "testnet output checked on testnet");
+    check(Transaction::verifyScript("", alice, mainnetOutput.script), "text script overload agrees");
+
+    // A script naming the address in a different case is a different lock, as before
+    std::string upper = mainnetOutput.address;
+    for (size_t i = 3; i < upper.size(); i++) {
+        upper[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(upper[i])));
+    }
+    if (upper != mainnetOutput.address) {
+        check(!Transaction::verifyScript("", alice, p2pkh(upper)), "case-changed address is refused");
+    }
+
+    // Hits share the cached address instead of copying it
+    std::shared_ptr<const DecodedAddress> first = AddressCache::derive(alice, false);
+    std::shared_ptr<const DecodedAddress> second = AddressCache::derive(alice, false);
+    check(first == second, "cache hit returns the shared entry");
+    check(AddressCache::derive(alice, true) != first, "networks are cached apart");
+}
+
+int main() {
+    testDecode();
+    testClassification();
+    testVerifyScript();
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "script template tests passed\n";
+    return 0;
+}
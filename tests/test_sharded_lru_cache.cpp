@@ -0,0 +1,122 @@
+// ShardedLruCache: charge-bounded eviction, and the read-through protocol that keeps
+// a miss racing a delete from caching the deleted record again.
+#include "../include/ShardedLruCache.h"
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+static void testEviction() {
+    ShardedLruCache<int, std::string, std::hash<int>, 1> cache(100);
+    std::string value;
+    cache.put(1, "a", 40);
+    cache.put(2, "b", 40);
+    check(cache.get(1, value), "entry present");
+    cache.put(3, "c", 40);
+    check(cache.get(1, value) && !cache.get(2, value) && cache.get(3, value), "least recently used evicted");
+    check(cache.getStats().usage == 80 && cache.getStats().evictions == 1, "usage follows charges");
+
+    cache.put(4, "d", 500);
+    check(cache.getStats().entries == 1 && cache.getStats().usage == 500, "oversized entry kept alone");
+    cache.erase(4);
+    check(cache.getStats().usage == 0, "erase releases the charge");
+}
+
+static void testStaleInsertRejected() {
+    ShardedLruCache<int, std::string> cache(64);
+    std::string value;
+
+    // Reader misses and starts loading; the record is deleted and invalidated meanwhile
+    uint64_t generation = cache.generation();
+    cache.invalidate(7);
+    check(!cache.putIfUnchanged(7, "stale", 1, generation), "load from before the delete is refused");
+    check(!cache.get(7, value), "deleted record not cached");
+
+    // A load that starts after the invalidation is cached normally
+    generation = cache.generation();
+    check(cache.putIfUnchanged(7, "fresh", 1, generation), "load after the delete is cached");
+    check(cache.get(7, value) && value == "fresh", "fresh value served");
+
+    generation = cache.generation();
+    cache.clear();
+    check(!cache.putIfUnchanged(8, "stale", 1, generation), "clear counts as an invalidation");
+}
+
+// Readers load through the cache while a writer deletes every even record from the
+// backing map and then invalidates it, as Database::deleteBlock does. Afterwards no
+// deleted record may be left in the cache.
+static void testConcurrentDelete() {
+    const int keys = 256;
+    const int lookupsPerReader = 200000;
+    std::mutex storeMutex;
+    std::map<int, std::shared_ptr<const int>> store;
+    for (int i = 0; i < keys; i++) {
+        store[i] = std::make_shared<const int>(i);
+    }
+
+    ShardedLruCache<int, std::shared_ptr<const int>> cache(keys * 2);
+
+    auto reader = [&](int seed) {
+        for (int i = 0; i < lookupsPerReader; i++) {
+            int key = (seed + i * 7) % keys;
+            std::shared_ptr<const int> value;
+            if (cache.get(key, value)) continue;
+            uint64_t generation = cache.generation();
+            {
+                std::lock_guard<std::mutex> lock(storeMutex);
+                auto found = store.find(key);
+                if (found == store.end()) continue;
+                value = found->second;
+            }
+            cache.putIfUnchanged(key, value, 1, generation);
+        }
+    };
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; i++) {
+        readers.emplace_back(reader, i * 31);
+    }
+    for (int key = 0; key < keys; key += 2) {
+        {
+            std::lock_guard<std::mutex> lock(storeMutex);
+            store.erase(key);
+        }
+        cache.invalidate(key);
+        std::this_thread::yield();
+    }
+    for (auto& thread : readers) {
+        thread.join();
+    }
+
+    size_t resurrected = 0;
+    for (int key = 0; key < keys; key += 2) {
+        std::shared_ptr<const int> value;
+        if (cache.get(key, value)) resurrected++;
+    }
+    check(resurrected == 0, "deleted record resurrected by a concurrent miss");
+}
+
+int main() {
+    testEviction();
+    testStaleInsertRejected();
+    testConcurrentDelete();
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "sharded LRU cache tests passed\n";
+    return 0;
+}
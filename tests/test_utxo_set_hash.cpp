@@ -0,0 +1,177 @@
+// UTXO set hash bookkeeping against a scratch database. After every kind of change
+// (new blocks, a block saved twice, a reorg, a deleted block, concurrent updates,
+// single-entry writes) the running hash, output count and total amount must equal
+// a full rescan of utxo:.
+#include "../include/Database.h"
+#include "../include/HashUtils.h"
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+static Block makeBlock(uint32_t height, const std::string& tag, const std::vector<Transaction>& transactions) {
+    Block block(height, keccak256("prev" + std::to_string(height)), BlockType::POW_SHA256);
+    block.setHash(keccak256(tag));
+    block.setTimestamp(1700000000 + height);
+    for (const auto& tx : transactions) {
+        block.addTransaction(tx);
+    }
+    return block;
+}
+
+static Transaction spend(const std::string& prevHash, uint32_t index, double amount,
+                         const std::vector<std::pair<std::string, double>>& payments) {
+    std::vector<TransactionInput> inputs(1);
+    inputs[0].txHash = prevHash;
+    inputs[0].outputIndex = index;
+    inputs[0].amount = amount;
+    std::vector<TransactionOutput> outputs;
+    for (const auto& payment : payments) {
+        TransactionOutput output;
+        output.address = payment.first;
+        output.amount = payment.second;
+        outputs.push_back(output);
+    }
+    return Transaction(std::move(inputs), std::move(outputs), prevHash);
+}
+
+static UtxoSetInfo running(Database& db) {
+    UtxoSetInfo info;
+    check(db.getUtxoSetInfo(info), "running UTXO set state readable");
+    return info;
+}
+
+// The running state must match what a full rescan of the stored outputs produces
+static void checkAgainstRescan(Database& db, const std::string& when) {
+    UtxoSetInfo before = running(db);
+    check(db.rebuildUtxoSetHash(), "rescan " + when);
+    UtxoSetInfo after = running(db);
+    check(before.hash == after.hash, "set hash matches a rescan " + when);
+    check(before.txoutCount == after.txoutCount, "output count matches a rescan " + when);
+    check(before.totalAmount == after.totalAmount, "total amount matches a rescan " + when);
+}
+
+static bool sameSet(const UtxoSetInfo& a, const UtxoSetInfo& b) {
+    return a.hash == b.hash && a.txoutCount == b.txoutCount && a.totalAmount == b.totalAmount;
+}
+
+int main() {
+    const std::string path = (std::filesystem::temp_directory_path() / "gxc_test_utxo_set_hash").string();
+    std::filesystem::remove_all(path);
+    if (!Database::initialize(path)) {
+        std::cerr << "FAIL: cannot open " << path << "\n";
+        return 1;
+    }
+    Database& db = Database::getInstance();
+
+    Transaction reward0("GXCalice", 50.0);
+    check(db.saveBlock(makeBlock(0, "b0", {reward0})), "block 0 saved");
+    UtxoSetInfo afterGenesis = running(db);
+    check(afterGenesis.txoutCount == 1 && afterGenesis.totalAmount == 50 * COIN, "genesis output counted");
+
+    // Block 1 spends the genesis output and, in a second transaction, one of its own outputs
+    Transaction pay = spend(reward0.getHash(), 0, 50.0, {{"GXCbob", 30.0}, {"GXCalice", 20.0}});
+    Transaction chained = spend(pay.getHash(), 0, 30.0, {{"GXCcarol", 29.75}});
+    Transaction reward1("GXCminer", 50.0);
+    Block block1 = makeBlock(1, "b1", {reward1, pay, chained});
+    check(db.saveBlock(block1), "block 1 saved");
+    UtxoSetInfo afterBlock1 = running(db);
+    check(afterBlock1.txoutCount == 3 && afterBlock1.totalAmount == 9975 * COIN / 100, "block 1 outputs counted once");
+    checkAgainstRescan(db, "after block 1");
+
+    // Saving the same block again changes nothing
+    check(db.saveBlock(block1), "block 1 saved again");
+    check(sameSet(running(db), afterBlock1), "re-saving a block is idempotent");
+    checkAgainstRescan(db, "after re-saving block 1");
+
+    Transaction reward2("GXCminer", 50.0);
+    Transaction payCarol = spend(chained.getHash(), 0, 29.75, {{"GXCdave", 29.5}});
+    check(db.saveBlock(makeBlock(2, "b2", {reward2, payCarol})), "block 2 saved");
+    checkAgainstRescan(db, "after block 2");
+
+    // A competing block 2 replaces the first one
+    Transaction reward2b("GXCother", 50.0);
+    Block block2b = makeBlock(2, "b2b", {reward2b});
+    check(db.saveBlock(block2b), "replacement block 2 saved");
+    UtxoSetInfo afterReorg = running(db);
+    check(afterReorg.txoutCount == afterBlock1.txoutCount + 1 &&
+          afterReorg.totalAmount == afterBlock1.totalAmount + 50 * COIN, "reorg undoes the replaced block");
+    TransactionOutput restored;
+    check(db.getUTXO(chained.getHash(), 0, restored) && restored.amount == 29.75, "reorg restores the spent output");
+    check(!db.getUTXO(payCarol.getHash(), 0, restored), "reorg removes the replaced block's outputs");
+    checkAgainstRescan(db, "after the reorg");
+
+    // Deleting the tip returns the set to its state after block 1
+    check(db.deleteBlock(2), "block 2 deleted");
+    check(sameSet(running(db), afterBlock1), "delete restores the previous set");
+    check(!db.getUTXO(reward2b.getHash(), 0, restored), "deleted block's outputs are gone");
+    checkAgainstRescan(db, "after deleting block 2");
+
+    // Concurrent standalone updates serialize on the set state
+    std::vector<Transaction> payouts;
+    for (int i = 0; i < 8; i++) {
+        payouts.push_back(Transaction("GXCpool" + std::to_string(i), 1.25));
+    }
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 8; i++) {
+        writers.emplace_back([&db, &payouts, i]() { db.updateUtxoSet(payouts[i], 3); });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    UtxoSetInfo afterPayouts = running(db);
+    check(afterPayouts.txoutCount == afterBlock1.txoutCount + 8 &&
+          afterPayouts.totalAmount == afterBlock1.totalAmount + 10 * COIN, "no concurrent update is lost");
+    checkAgainstRescan(db, "after concurrent updates");
+
+    // Single-entry writes keep the state and the address index in step
+    TransactionOutput loose;
+    loose.address = "GXCloose";
+    loose.amount = 2.5;
+    check(db.storeUTXO(keccak256("loose"), 0, loose, 3), "loose output stored");
+    UtxoSetInfo afterStore = running(db);
+    check(afterStore.txoutCount == afterPayouts.txoutCount + 1 &&
+          afterStore.totalAmount == afterPayouts.totalAmount + 25 * COIN / 10, "stored output counted");
+    check(db.getUTXOsByAddress("GXCloose").size() == 1, "stored output indexed by address");
+    check(db.storeUTXO(keccak256("loose"), 0, loose, 3), "loose output stored again");
+    check(sameSet(running(db), afterStore), "storing the same output twice counts it once");
+    checkAgainstRescan(db, "after storing an output");
+
+    check(db.deleteUTXO(keccak256("loose"), 0), "loose output deleted");
+    check(sameSet(running(db), afterPayouts), "deleting the output restores the set");
+    check(db.getUTXOsByAddress("GXCloose").empty(), "deleted output leaves the address index");
+    check(db.deleteUTXO(keccak256("loose"), 0) && sameSet(running(db), afterPayouts), "deleting a missing output changes nothing");
+    checkAgainstRescan(db, "after deleting an output");
+
+    // Amounts with no exact binary form: the running total must not drift from a
+    // rescan that adds the same outputs in key order
+    for (int i = 0; i < 200; i++) {
+        TransactionOutput dust;
+        dust.address = "GXCdust";
+        dust.amount = 0.1 * (i % 7 + 1) + 0.07 * i + 0.003;
+        check(db.storeUTXO(keccak256("dust" + std::to_string(i)), 0, dust, 3), "dust output stored");
+    }
+    for (int i = 0; i < 200; i += 3) {
+        check(db.deleteUTXO(keccak256("dust" + std::to_string(i)), 0), "dust output deleted");
+    }
+    checkAgainstRescan(db, "after fractional amounts");
+
+    Database::shutdown();
+    std::filesystem::remove_all(path);
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "UTXO set hash tests passed\n";
+    return 0;
+}
@@ -0,0 +1,127 @@
+// UTXO snapshot export and import between two scratch databases, historical balances
+// seeded at the snapshot base, and rejection of manifests whose chunk file names do not
+// match the canonical utxo-NNNNNN.chunk form.
+#include "../include/Database.h"
+#include "../include/HashUtils.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+static Block makeBlock(uint32_t height, const std::string& tag, const std::vector<Transaction>& transactions) {
+    Block block(height, keccak256("prev" + std::to_string(height)), BlockType::POW_SHA256);
+    block.setHash(keccak256(tag));
+    block.setTimestamp(1700000000 + height);
+    for (const auto& tx : transactions) {
+        block.addTransaction(tx);
+    }
+    return block;
+}
+
+static std::string readFile(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+static void writeFile(const std::filesystem::path& path, const std::string& contents) {
+    std::ofstream file(path, std::ios::trunc);
+    file << contents;
+}
+
+// Imports snapshotDir into a fresh database at path and reports whether it was accepted
+static bool importInto(const std::string& path, const std::string& snapshotDir) {
+    std::filesystem::remove_all(path);
+    if (!Database::initialize(path)) {
+        std::cerr << "FAIL: cannot open " << path << "\n";
+        failures++;
+        return false;
+    }
+    bool imported = Database::getInstance().importUtxoSnapshot(snapshotDir);
+    Database::shutdown();
+    std::filesystem::remove_all(path);
+    return imported;
+}
+
+int main() {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "gxc_test_utxo_snapshot";
+    const std::string sourcePath = (root / "source").string();
+    const std::string targetPath = (root / "target").string();
+    const std::filesystem::path snapshotDir = root / "snapshot";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    if (!Database::initialize(sourcePath)) {
+        std::cerr << "FAIL: cannot open " << sourcePath << "\n";
+        return 1;
+    }
+    Database& db = Database::getInstance();
+    check(db.saveBlock(makeBlock(0, "b0", {Transaction("GXCalice", 50.0)})), "block 0 saved");
+    check(db.saveBlock(makeBlock(1, "b1", {Transaction("GXCbob", 50.0)})), "block 1 saved");
+    check(db.exportUtxoSnapshot(snapshotDir.string(), 1), "snapshot exported");
+    Database::shutdown();
+
+    check(importInto(targetPath, snapshotDir.string()), "untampered snapshot imports");
+
+    // Running balances start at the base and chain into the blocks saved above it
+    std::filesystem::remove_all(targetPath);
+    if (Database::initialize(targetPath)) {
+        Database& target = Database::getInstance();
+        double balance = -1;
+        check(target.importUtxoSnapshot(snapshotDir.string()), "snapshot imports for balance checks");
+        check(target.getAddressBalanceAt("GXCalice", 1, balance) && balance == 50.0, "balance seeded at the base");
+        check(target.getAddressBalanceAt("GXCbob", 1, balance) && balance == 50.0, "every address seeded");
+        check(!target.getAddressBalanceAt("GXCalice", 0, balance), "balance below the base refused");
+
+        check(target.saveBlock(makeBlock(2, "b2", {Transaction("GXCalice", 25.0)})), "block above the base saved");
+        check(target.getAddressBalanceAt("GXCalice", 2, balance) && balance == 75.0, "block chains from the seed");
+        check(target.getAddressBalanceAt("GXCalice", 1, balance) && balance == 50.0, "base balance unchanged");
+
+        check(target.rebuildAddressHistory(), "address history rebuilt");
+        check(target.getAddressBalanceAt("GXCalice", 2, balance) && balance == 75.0, "rebuild keeps the seed");
+        check(target.getAddressBalanceAt("GXCbob", 2, balance) && balance == 50.0, "untouched address keeps the seed");
+        Database::shutdown();
+    } else {
+        check(false, "cannot open " + targetPath);
+    }
+    std::filesystem::remove_all(targetPath);
+
+    // A chunk name that walks out of the snapshot directory is refused before any file is opened.
+    // The commitment does not cover file names, so it cannot catch this on its own.
+    const std::string manifest = readFile(snapshotDir / "manifest.json");
+    const std::string canonical = "\"utxo-000000.chunk\"";
+    check(manifest.find(canonical) != std::string::npos, "manifest names the first chunk canonically");
+
+    std::filesystem::create_directories(root / "elsewhere");
+    std::filesystem::copy_file(snapshotDir / "utxo-000000.chunk", root / "elsewhere" / "utxo-000000.chunk");
+    for (const std::string& name : {"../elsewhere/utxo-000000.chunk", "./utxo-000000.chunk",
+                                    "utxo-000001.chunk", "utxo-0.chunk", "/etc/passwd"}) {
+        std::string tampered = manifest;
+        tampered.replace(tampered.find(canonical), canonical.size(), "\"" + name + "\"");
+        writeFile(snapshotDir / "manifest.json", tampered);
+        check(!importInto(targetPath, snapshotDir.string()), "chunk name " + name + " rejected");
+    }
+
+    writeFile(snapshotDir / "manifest.json", manifest);
+    check(importInto(targetPath, snapshotDir.string()), "restored manifest imports again");
+
+    std::filesystem::remove_all(root);
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "UTXO snapshot tests passed\n";
+    return 0;
+}
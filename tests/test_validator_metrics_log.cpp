@@ -0,0 +1,103 @@
+// ValidatorMetricsLog against a scratch LevelDB: deltas only land for validators with
+// a stored record, fold into it, and orphans left by older builds are dropped on load.
+#include "../include/ValidatorMetricsLog.h"
+#include <filesystem>
+#include <iostream>
+#include <leveldb/db.h>
+#include <memory>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+static size_t countDeltas(leveldb::DB* db) {
+    size_t count = 0;
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(leveldb::ReadOptions()));
+    for (it->Seek("vald:"); it->Valid() && it->key().starts_with("vald:"); it->Next()) {
+        count++;
+    }
+    return count;
+}
+
+int main() {
+    const std::string path = (std::filesystem::temp_directory_path() / "gxc_test_validator_metrics_log").string();
+    std::filesystem::remove_all(path);
+    leveldb::Options options;
+    options.create_if_missing = true;
+    leveldb::DB* raw = nullptr;
+    if (!leveldb::DB::Open(options, path, &raw).ok()) {
+        std::cerr << "FAIL: cannot open " << path << "\n";
+        return 1;
+    }
+    std::unique_ptr<leveldb::DB> db(raw);
+    leveldb::WriteOptions writeOptions;
+
+    json base;
+    base["address"] = "V1";
+    base["blocks_produced"] = 10;
+    base["total_rewards"] = 5.0;
+
+    ValidatorDelta produced;
+    produced.blocksProduced = 1;
+    produced.totalRewards = 2.5;
+
+    {
+        ValidatorMetricsLog log(db.get(), writeOptions, "val:", "vald:");
+        check(log.load(), "empty log loads");
+        check(log.replace("V1", base.dump()), "base record stored");
+
+        // A block naming an unknown validator is refused as a whole
+        check(!log.append({{"V1", produced}, {"V2", produced}}), "delta for an unstored validator refused");
+        check(countDeltas(db.get()) == 0 && log.getStats().deltasAppended == 0, "refused block writes nothing");
+        check(log.pending("V1").blocksProduced == 0, "refused block leaves no pending sum");
+
+        for (int i = 0; i < 4; i++) {
+            check(log.append({{"V1", produced}}), "delta for a stored validator appended");
+        }
+        std::string record;
+        ValidatorDelta pending;
+        check(log.read("V1", record, pending) && pending.blocksProduced == 4, "pending deltas visible to reads");
+
+        check(log.foldAll(), "fold succeeds");
+        check(log.read("V1", record, pending) && pending.blocksProduced == 0, "nothing pending after fold");
+        json folded = json::parse(record);
+        check(folded["blocks_produced"] == 14 && folded["total_rewards"] == 15.0, "deltas folded into the record");
+        check(countDeltas(db.get()) == 0, "folded deltas deleted");
+
+        // Removing the validator makes later deltas for it invalid again
+        check(log.remove("V1"), "validator removed");
+        check(!log.append({{"V1", produced}}), "delta after removal refused");
+        check(log.replace("V1", base.dump()), "base record stored again");
+        check(log.append({{"V1", produced}}), "delta pending across reload");
+    }
+
+    // An orphaned delta, as an older build could leave, is dropped on load; the
+    // pending delta of a stored validator survives
+    db->Put(writeOptions, "vald:V3:00000000000000000999", "{\"blocks_produced\":1}");
+    {
+        ValidatorMetricsLog log(db.get(), writeOptions, "val:", "vald:");
+        check(log.load(), "log with an orphan loads");
+        check(log.pending("V3").blocksProduced == 0, "orphaned delta not pending");
+        check(log.pending("V1").blocksProduced == 1, "stored validator keeps its pending delta");
+        check(countDeltas(db.get()) == 1, "orphaned delta deleted");
+        check(log.foldAll() && log.getStats().pendingValidators == 0, "every remaining delta folds");
+    }
+
+    db.reset();
+    std::filesystem::remove_all(path);
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "validator metrics log tests passed\n";
+    return 0;
+}